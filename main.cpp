@@ -1,405 +1,7581 @@
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <charconv>
+#include <chrono>
+#include <climits>
+#include <cmath>
+#include <condition_variable>
+#include <coroutine>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <functional>
 #include <iostream>
+#include <memory_resource>
+#include <mutex>
+#include <new>
+#include <queue>
+#include <random>
 #include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#ifdef _WIN32
+#include <fcntl.h>
+#include <io.h>
+#else
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#endif
+
+// Recorridos de notas con instrucciones vectoriales de x86-64, elegidos al
+// arrancar según el procesador; el resto de compiladores de la misma
+// función no necesitan opciones especiales
+#if defined(__x86_64__) || defined(_M_X64)
+#include <immintrin.h>
+#define PARCIAL_SIMD_X86
+#if defined(__GNUC__)
+#define DESTINO_SIMD(instrucciones) __attribute__((target(instrucciones)))
+#else
+#define DESTINO_SIMD(instrucciones)
+#endif
+#endif
+
+#ifdef PARCIAL_METRICAS
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#elif defined(_M_X64) || defined(_M_IX86)
+#include <intrin.h>
+#endif
+#endif
 
 using namespace std;
 
+
+#ifdef PARCIAL_METRICAS
 /**
- * Estructura Alumno para manejar los datos de un alumno
- * Consta de un campo "nombre" de tipo string
- * y campo "nota" de tipo float
+ * Operaciones de la aplicación que se instrumentan cuando se compila con
+ * PARCIAL_METRICAS definido. Sin esa macro toda la instrumentación desaparece
+ * del binario
  */
-struct Alumno {
-    string nombre; // Campo nombre (string)
-    float nota; // Campo nota (float)
+enum OperacionMedida {
+    OP_ADD_ALUMNO,
+    OP_NOTA_MEDIA,
+    OP_ALUMNO_MAX_NOTA,
+    OP_EXISTE_SUSPENSO,
+    OP_PRINT_ALUMNO,
+    OP_PRINT_LISTA,
+    OP_PRINT_NOTA_MEDIA,
+    OP_PRINT_MAX_NOTA,
+    OP_PRINT_SUSPENSO,
+    OP_INPUT_NOTA,
+    OP_INPUT_NOMBRE,
+    OP_INPUT_ALUMNO,
+    OP_INPUT_CAPACIDAD,
+    OP_CONTAR_ENTRE_NOTAS,
+    OP_LISTAR_ENTRE_NOTAS,
+    OP_PUESTO_ALUMNO,
+    OP_PRINT_ENTRE_NOTAS,
+    OP_PRINT_LISTA_ORDENADA,
+    OP_PRINT_LISTA_PAGINAS,
+    OP_PRINT_PERCENTILES,
+    OP_PRINT_FRANJAS,
+    NUM_OPERACIONES_MEDIDAS
+};
+
+const char *const NOMBRES_OPERACIONES[NUM_OPERACIONES_MEDIDAS] = {
+    "addAlumno", "getNotaMedia", "getAlumnoMaxNota", "existeAlumnoSuspenso",
+    "printAlumno", "printLista", "printNotaMedia", "printAlumnoMaxNota",
+    "printCheckAlumnoSuspenso", "inputNota", "inputNombre", "inputAlumno",
+    "inputCapacidad", "contarEntreNotas", "listarEntreNotas", "getPuestoAlumno",
+    "printAlumnosEntreNotas", "printListaOrdenada", "printListaPorPaginas", "printPercentiles",
+    "printFranjasNotas"
 };
 
+// Cubeta i del histograma: latencias con bit_width(ticks) == i,
+// es decir, en el intervalo [2^(i-1), 2^i) ticks
+const int NUM_CUBETAS = 65;
 
 /**
- * Pide la nota del alumno mediante entrada por teclado
- * Comprueba que la nota está entre 0 y 10 y si no es así
- * vuelve a pedir al usuario la introducción de la nota
- * @return Un valor entre 0 y 10, correspondiente a una nota numérica
+ * Contadores de una operación: llamadas, ticks acumulados, máximo e
+ * histograma logarítmico de latencias. Son atómicos (con orden relajado)
+ * para poder medir también operaciones llamadas desde varios hilos
  */
-float inputNota() {
-    float nota;
-    do {
-        std::cout << "Introduce una nota numerica de 0 a 10:";
-        cin >> nota;
-    } while (nota < 0 || nota > 10);
-    return nota;
+struct MetricaOperacion {
+    atomic<uint64_t> llamadas;
+    atomic<uint64_t> ticksTotales;
+    atomic<uint64_t> ticksMax;
+    atomic<uint64_t> cubetas[NUM_CUBETAS];
+};
+
+MetricaOperacion metricas[NUM_OPERACIONES_MEDIDAS];
+
+
+/**
+ * Fuente de tiempo barata: el contador de ciclos del procesador (rdtsc)
+ * cuando está disponible y el reloj monótono en otro caso
+ * @return Marca de tiempo en ticks
+ */
+inline uint64_t leerTicks() {
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+    return __rdtsc();
+#else
+    return chrono::steady_clock::now().time_since_epoch().count();
+#endif
 }
 
 
 /**
- * Pide el nombre y apellidos del alumno mediante entrada por teclado
- * Comprueba que el texto no esté vacío, de lo contrario
- * vuelve a pedir al usuario la introducción del dato
- * @return Un string con el nombre y apellidos
+ * Referencia tomada al arrancar para convertir ticks a nanosegundos
+ * comparando con el reloj monótono en el momento de volcar las métricas
  */
-string inputNombre() {
-    string nombre;
-    do {
-        cout << "Introduce un nombre para el alumno:";
-        getline(cin, nombre);
-        if (nombre.empty()) {
-            cout << "El nombre no puede quedar vacio!!!\n";
+struct CalibracionTicks {
+    uint64_t ticks = leerTicks();
+    chrono::steady_clock::time_point instante = chrono::steady_clock::now();
+};
+
+const CalibracionTicks calibracionTicks;
+
+
+/**
+ * Calcula cuántos nanosegundos equivale un tick de leerTicks
+ * @return Nanosegundos por tick
+ */
+double getNanosegundosPorTick() {
+    const uint64_t ticks = leerTicks() - calibracionTicks.ticks;
+    const auto ns = chrono::duration_cast<chrono::nanoseconds>(
+        chrono::steady_clock::now() - calibracionTicks.instante).count();
+    if (ticks == 0 || ns <= 0) return 1.0;
+    return static_cast<double>(ns) / static_cast<double>(ticks);
+}
+
+
+/**
+ * Acumula una medida de latencia en los contadores de la operación
+ * @param op Operación medida
+ * @param ticks Duración en ticks
+ */
+inline void registrarMedida(const OperacionMedida op, const uint64_t ticks) {
+    MetricaOperacion &m = metricas[op];
+    m.llamadas.fetch_add(1, memory_order_relaxed);
+    m.ticksTotales.fetch_add(ticks, memory_order_relaxed);
+    m.cubetas[bit_width(ticks)].fetch_add(1, memory_order_relaxed);
+    uint64_t max = m.ticksMax.load(memory_order_relaxed);
+    while (ticks > max and not m.ticksMax.compare_exchange_weak(max, ticks, memory_order_relaxed)) {
+    }
+}
+
+
+/**
+ * Objeto que mide el tiempo entre su creación y su destrucción, es decir,
+ * la duración del ámbito (normalmente la función) en el que se declara
+ */
+struct MedidorOperacion {
+    OperacionMedida op;
+    uint64_t inicio;
+
+    explicit MedidorOperacion(const OperacionMedida op) : op(op), inicio(leerTicks()) {
+    }
+
+    ~MedidorOperacion() { registrarMedida(op, leerTicks() - inicio); }
+};
+
+#define MEDIR_OPERACION(op) const MedidorOperacion medidorOperacion(op)
+
+
+/**
+ * Aproxima un percentil a partir del histograma logarítmico devolviendo
+ * el límite superior de la cubeta en la que cae, acotado por el máximo
+ * @param m Métricas de la operación
+ * @param p Percentil entre 0 y 1
+ * @return Latencia en ticks
+ */
+uint64_t getPercentilTicks(const MetricaOperacion &m, const double p) {
+    const uint64_t total = m.llamadas.load(memory_order_relaxed);
+    const uint64_t max = m.ticksMax.load(memory_order_relaxed);
+    const auto objetivo = static_cast<uint64_t>(p * static_cast<double>(total) + 0.5);
+    uint64_t acumulado = 0;
+    for (int i = 0; i < NUM_CUBETAS; i++) {
+        acumulado += m.cubetas[i].load(memory_order_relaxed);
+        if (acumulado >= objetivo and acumulado > 0) {
+            const uint64_t limite = i == 0 ? 0 : i >= 64 ? UINT64_MAX : (uint64_t{1} << i) - 1;
+            return limite < max ? limite : max;
         }
-    } while (nombre.empty());
-    return nombre;
+    }
+    return max;
 }
 
 
 /**
- * Apoyándose en los métodos inputNota e inputNombre
- * obtiene los datos de un alumno: nombre y nota para crear una
- * estructura Alumno de manera dinámica, inicializar sus campos nombre
- * y apellido con los datos introducidos por el usuario,
- * para finalmente devolver un puntero al Alumno
- * @return Puntero a la memoria reservada dinámicamente
- * para almacenar una estructura de tipo Alumno
- */
-Alumno *inputAlumno() {
-    Alumno *alumno = new Alumno;
-    cout << "Introduce datos del alumno...\n";
-    alumno->nombre = inputNombre();
-    alumno->nota = inputNota();
-    return alumno;
+ * Imprime por consola una tabla con las métricas de todas las operaciones
+ * que se han llamado al menos una vez: llamadas, tiempo acumulado, media,
+ * percentiles 50 y 99 y latencia máxima
+ */
+void printMetricas() {
+    const double nsPorTick = getNanosegundosPorTick();
+    cout << "\nMETRICAS (tiempos en microsegundos):" << endl;
+    printf("%-26s %10s %12s %10s %10s %10s %10s\n",
+           "Operacion", "Llamadas", "Total", "Media", "p50", "p99", "Max");
+    for (int op = 0; op < NUM_OPERACIONES_MEDIDAS; op++) {
+        const MetricaOperacion &m = metricas[op];
+        const uint64_t llamadas = m.llamadas.load(memory_order_relaxed);
+        if (llamadas == 0) continue;
+        const double us = nsPorTick / 1000.0;
+        const double total = static_cast<double>(m.ticksTotales.load(memory_order_relaxed)) * us;
+        printf("%-26s %10llu %12.3f %10.3f %10.3f %10.3f %10.3f\n",
+               NOMBRES_OPERACIONES[op], static_cast<unsigned long long>(llamadas), total,
+               total / static_cast<double>(llamadas),
+               static_cast<double>(getPercentilTicks(m, 0.50)) * us,
+               static_cast<double>(getPercentilTicks(m, 0.99)) * us,
+               static_cast<double>(m.ticksMax.load(memory_order_relaxed)) * us);
+    }
+    fflush(stdout);
 }
+#else
+#define MEDIR_OPERACION(op)
+#endif
+
+
+// Bytes de las funciones que una tarea del pool guarda dentro de sí misma
+const size_t TAM_TAREA = 48;
 
 
 /**
- * Estructura para manejar una lista de alumnos
- * El campo capacidad especifica el número máximo de alumnos que podrá
- * manejar la lista
- * El campo num reflejará la cantidad real de alumnos que hay en la lista
- * El campo alumnos servirá para apuntar a memoria dinámica, concretamente
- * debe manejar un "array" de punteros a estructura de tipo Alumno
+ * Tarea del pool de hilos: una función sin argumentos que se puede mover
+ * pero no copiar. Si la función (la lambda con sus capturas) cabe en
+ * TAM_TAREA bytes se guarda dentro de la propia tarea, de modo que
+ * encolar las tareas de paraCada y lanzarTarea no reserva memoria; si no
+ * cabe se guarda en el heap
+ * El campo ejecutar llama a la función guardada en datos y el campo
+ * trasladar la mueve a otra tarea o, si el destino es nulo, la destruye;
+ * los dos son nulos en una tarea vacía
  */
-struct ListaAlumnos {
-    int capacidad;
-    int num;
-    Alumno **alumnos;
+struct Tarea {
+    alignas(max_align_t) byte datos[TAM_TAREA];
+    void (*ejecutar)(byte *datos) = nullptr;
+    void (*trasladar)(byte *destino, byte *origen) = nullptr;
+
+    Tarea() = default;
+
+    template<typename F> requires (not is_same_v<decay_t<F>, Tarea>)
+    Tarea(F &&funcion) {
+        using Funcion = decay_t<F>;
+        if constexpr (sizeof(Funcion) <= TAM_TAREA and alignof(Funcion) <= alignof(max_align_t) and
+                      is_nothrow_move_constructible_v<Funcion>) {
+            new(datos) Funcion(std::forward<F>(funcion));
+            ejecutar = [](byte *datos) { (*launder(reinterpret_cast<Funcion *>(datos)))(); };
+            trasladar = [](byte *destino, byte *origen) {
+                Funcion *guardada = launder(reinterpret_cast<Funcion *>(origen));
+                if (destino != nullptr) new(destino) Funcion(std::move(*guardada));
+                guardada->~Funcion();
+            };
+        } else {
+            new(datos) Funcion *(new Funcion(std::forward<F>(funcion)));
+            ejecutar = [](byte *datos) { (**launder(reinterpret_cast<Funcion **>(datos)))(); };
+            trasladar = [](byte *destino, byte *origen) {
+                Funcion *guardada = *launder(reinterpret_cast<Funcion **>(origen));
+                if (destino != nullptr) new(destino) Funcion *(guardada);
+                else delete guardada;
+            };
+        }
+    }
+
+    Tarea(Tarea &&otra) noexcept {
+        tomar(otra);
+    }
+
+    Tarea &operator=(Tarea &&otra) noexcept {
+        if (this != &otra) {
+            vaciar();
+            tomar(otra);
+        }
+        return *this;
+    }
+
+    ~Tarea() {
+        vaciar();
+    }
+
+    void operator()() { ejecutar(datos); }
+
+    /**
+     * Pasa a esta tarea vacía la función de otra, que queda vacía
+     * @param otra Referencia a la tarea de la que se toma la función
+     */
+    void tomar(Tarea &otra) noexcept {
+        ejecutar = exchange(otra.ejecutar, nullptr);
+        trasladar = exchange(otra.trasladar, nullptr);
+        if (trasladar != nullptr) trasladar(datos, otra.datos);
+    }
+
+    /**
+     * Destruye la función guardada, si la hay, y deja la tarea vacía
+     */
+    void vaciar() noexcept {
+        if (trasladar != nullptr) trasladar(nullptr, datos);
+        ejecutar = nullptr;
+        trasladar = nullptr;
+    }
 };
 
+
 /**
- * Pide al usuario la capacidad maxima de almacenar Alumnos en una lista
- * Comprueba que el valor es un número positivo mayor que cero,
- * si no es así, vuelve a preguntar al usuario
- * @return Un valor positivo distinto de cero
+ * Cola de tareas de un hilo del pool
+ * El hilo propietario toma sus tareas por el final (la última que encoló,
+ * cuyos datos es más probable que sigan en caché) y los demás hilos le
+ * roban tareas por el principio cuando se quedan sin trabajo
  */
-int inputCapacidad() {
-    int capacidad;
-    do {
-        cout << "Introduce capacidad maxima de la lista de alumnos:";
-        cin >> capacidad;
-        if (capacidad <= 0) {
-            cout << "La capacidad tiene que ser un valor positivo!\n";
+struct ColaTareas {
+    mutex cerrojo;
+    deque<Tarea> tareas;
+};
+
+
+/**
+ * Estructura para manejar el pool de hilos compartido por todas las
+ * operaciones paralelas del programa
+ * El campo colas tiene una cola de tareas por cada hilo del campo trabajadores
+ * El campo enCola cuenta las tareas encoladas en todas las colas; los hilos
+ * sin trabajo esperan en aviso, protegido por cerrojo, a que no sea cero
+ * El campo siguienteCola reparte por turno las tareas que se encolan desde
+ * fuera del pool
+ */
+struct PoolHilos {
+    vector<ColaTareas> colas;
+    vector<thread> trabajadores;
+    mutex cerrojo;
+    condition_variable aviso;
+    atomic<int64_t> enCola{0};
+    atomic<unsigned> siguienteCola{0};
+    bool terminar = false;
+};
+
+PoolHilos *poolHilos = nullptr; // Se crea al arrancar con iniciarPool
+thread_local int trabajadorActual = -1; // Posición del hilo en el pool o -1 si no es del pool
+
+
+/**
+ * Toma una tarea para el hilo de la posición indicada: primero la última
+ * de su propia cola y, si está vacía, la primera de la cola de otro hilo
+ * @param pool Puntero a una estructura de tipo PoolHilos
+ * @param propia Posición del hilo en el pool o -1 si no es del pool
+ * @param tarea Referencia donde se deja la tarea tomada
+ * @return true si se ha tomado una tarea
+ */
+bool tomarTarea(PoolHilos *pool, const int propia, Tarea &tarea) {
+    if (pool->enCola.load(memory_order_acquire) == 0) return false;
+    const int numColas = static_cast<int>(pool->colas.size());
+    if (propia >= 0) {
+        ColaTareas &cola = pool->colas[propia];
+        const lock_guard bloqueo(cola.cerrojo);
+        if (not cola.tareas.empty()) {
+            tarea = std::move(cola.tareas.back());
+            cola.tareas.pop_back();
+            pool->enCola--;
+            return true;
         }
-    } while (capacidad <= 0);
-    return capacidad;
+    }
+    for (int i = 1; i <= numColas; i++) {
+        const int victima = (max(propia, 0) + i) % numColas;
+        if (victima == propia) continue;
+        ColaTareas &cola = pool->colas[victima];
+        const lock_guard bloqueo(cola.cerrojo);
+        if (not cola.tareas.empty()) {
+            tarea = std::move(cola.tareas.front());
+            cola.tareas.pop_front();
+            pool->enCola--;
+            return true;
+        }
+    }
+    return false;
+}
+
+
+/**
+ * Encola una tarea en el pool: en la cola del propio hilo si se llama desde
+ * una tarea y, si no, en la de un hilo elegido por turno
+ * Sin pool, la tarea se ejecuta en el momento en el hilo que la encola
+ * @param tarea Función a ejecutar
+ */
+void encolarTarea(Tarea tarea) {
+    PoolHilos *pool = poolHilos;
+    if (pool == nullptr) {
+        tarea();
+        return;
+    }
+    const int numColas = static_cast<int>(pool->colas.size());
+    const int destino = trabajadorActual >= 0 ? trabajadorActual : static_cast<int>(pool->siguienteCola++ % numColas);
+    {
+        const lock_guard bloqueo(pool->colas[destino].cerrojo);
+        pool->colas[destino].tareas.push_back(std::move(tarea));
+    }
+    pool->enCola++;
+    {
+        const lock_guard bloqueo(pool->cerrojo); // Evita que se pierda el aviso a un hilo que va a esperar
+    }
+    pool->aviso.notify_one();
+}
+
+
+/**
+ * Bucle de cada hilo del pool: ejecuta tareas mientras las haya y espera
+ * cuando no queda ninguna, hasta que se detiene el pool
+ * @param pool Puntero a una estructura de tipo PoolHilos
+ * @param posicion Posición del hilo en el pool
+ */
+void ejecutarTrabajador(PoolHilos *pool, const int posicion) {
+    trabajadorActual = posicion;
+    Tarea tarea;
+    while (true) {
+        if (tomarTarea(pool, posicion, tarea)) {
+            tarea();
+            tarea.vaciar();
+            continue;
+        }
+        unique_lock bloqueo(pool->cerrojo);
+        pool->aviso.wait(bloqueo, [pool] { return pool->terminar or pool->enCola.load() > 0; });
+        if (pool->terminar and pool->enCola.load() == 0) return;
+    }
+}
+
+
+/**
+ * Crea el pool de hilos del programa, una sola vez al arrancar
+ * @param numHilos Número de hilos del pool, al menos uno
+ */
+void iniciarPool(const int numHilos) {
+    PoolHilos *pool = new PoolHilos;
+    pool->colas = vector<ColaTareas>(max(1, numHilos));
+    for (int i = 0; i < static_cast<int>(pool->colas.size()); i++) {
+        pool->trabajadores.emplace_back(ejecutarTrabajador, pool, i);
+    }
+    poolHilos = pool;
+}
+
+
+/**
+ * Detiene el pool de hilos del programa después de que sus hilos
+ * terminen las tareas pendientes y libera su memoria
+ */
+void detenerPool() {
+    PoolHilos *pool = poolHilos;
+    if (pool == nullptr) return;
+    {
+        const lock_guard bloqueo(pool->cerrojo);
+        pool->terminar = true;
+    }
+    pool->aviso.notify_all();
+    for (thread &trabajador: pool->trabajadores) trabajador.join();
+    poolHilos = nullptr;
+    delete pool;
+}
+
+
+/**
+ * Devuelve cuántos hilos tiene el pool, o 1 si no se ha creado
+ * @return Número de hilos del pool
+ */
+int getNumHilosPool() {
+    return poolHilos == nullptr ? 1 : static_cast<int>(poolHilos->colas.size());
+}
+
+
+/**
+ * Grupo de tareas lanzadas al pool que se esperan juntas
+ * El campo pendientes cuenta las tareas del grupo que aún no han terminado;
+ * cada tarea lo decrementa con el cerrojo cogido y avisa en terminada al
+ * hilo que espera al grupo
+ */
+struct GrupoTareas {
+    atomic<int> pendientes{0};
+    mutex cerrojo;
+    condition_variable terminada;
+};
+
+
+/**
+ * Lanza una tarea al pool como parte de un grupo
+ * @param grupo Puntero a una estructura de tipo GrupoTareas
+ * @param tarea Función a ejecutar
+ */
+template<typename F>
+void lanzarTarea(GrupoTareas *grupo, F &&tarea) {
+    grupo->pendientes++;
+    encolarTarea([grupo, tarea = std::forward<F>(tarea)]() mutable {
+        tarea();
+        // Con el cerrojo cogido el grupo no se destruye hasta después del aviso
+        const lock_guard bloqueo(grupo->cerrojo);
+        grupo->pendientes.fetch_sub(1, memory_order_release);
+        grupo->terminada.notify_all();
+    });
+}
+
+
+/**
+ * Espera a que terminen todas las tareas de un grupo. Mientras espera, el
+ * hilo ejecuta tareas del pool, de modo que una tarea puede lanzar y
+ * esperar otras sin dejar hilos parados; si no hay ninguna que tomar, se
+ * bloquea hasta que termine otra tarea del grupo y vuelve a intentarlo
+ * @param grupo Puntero a una estructura de tipo GrupoTareas
+ */
+void esperarGrupo(GrupoTareas *grupo) {
+    Tarea tarea;
+    int pendientes;
+    while ((pendientes = grupo->pendientes.load(memory_order_acquire)) > 0) {
+        if (poolHilos != nullptr and tomarTarea(poolHilos, trabajadorActual, tarea)) {
+            tarea();
+            tarea.vaciar();
+            continue;
+        }
+        unique_lock bloqueo(grupo->cerrojo);
+        grupo->terminada.wait(bloqueo, [grupo, pendientes] { return grupo->pendientes.load() != pendientes; });
+    }
+    const lock_guard bloqueo(grupo->cerrojo); // La última tarea puede estar avisando todavía
+}
+
+
+/**
+ * Ejecuta en paralelo el cuerpo sobre el rango de posiciones [inicio, fin),
+ * dividiéndolo por mitades hasta que los trozos no superan el grano
+ * El hilo que llama ejecuta el primer trozo y espera a los demás
+ * @param inicio Primera posición del rango
+ * @param fin Posición siguiente a la última del rango
+ * @param grano Tamaño máximo de cada trozo, al menos 1
+ * @param cuerpo Función que recibe las posiciones desde y hasta de cada trozo
+ */
+void paraCada(const int64_t inicio, int64_t fin, const int64_t grano,
+              const function<void(int64_t, int64_t)> &cuerpo) {
+    if (inicio >= fin) return;
+    GrupoTareas grupo;
+    while (fin - inicio > max<int64_t>(grano, 1)) {
+        const int64_t mitad = inicio + (fin - inicio) / 2;
+        lanzarTarea(&grupo, [mitad, fin, grano, &cuerpo] { paraCada(mitad, fin, grano, cuerpo); });
+        fin = mitad;
+    }
+    cuerpo(inicio, fin);
+    esperarGrupo(&grupo);
+}
+
+/**
+ * Variantes de los recorridos de columnas de notas, de menos a más
+ * instrucciones vectoriales necesarias. Todas dan el mismo resultado
+ * salvo el redondeo de la suma, que se acumula en double en otro orden
+ */
+enum VarianteSimd {
+    SIMD_ESCALAR,
+    SIMD_SSE42,
+    SIMD_AVX2,
+    SIMD_AVX512,
+    NUM_VARIANTES_SIMD
+};
+
+
+/**
+ * Recorridos de una columna de notas de n floats seguidos
+ * sumar: suma de las notas en double
+ * contarMenores: número de notas estrictamente menores que el umbral
+ * posicionMaxima: primera posición con la nota más alta, o -1 si n es 0
+ */
+struct KernelsNotas {
+    const char *nombre;
+    double (*sumar)(const float *notas, int64_t n);
+    int64_t (*contarMenores)(const float *notas, int64_t n, float umbral);
+    int64_t (*posicionMaxima)(const float *notas, int64_t n);
+};
+
+
+double sumarNotasEscalar(const float *notas, const int64_t n) {
+    double suma = 0;
+    for (int64_t i = 0; i < n; i++) suma += notas[i];
+    return suma;
+}
+
+
+int64_t contarMenoresEscalar(const float *notas, const int64_t n, const float umbral) {
+    int64_t total = 0;
+    for (int64_t i = 0; i < n; i++) total += notas[i] < umbral;
+    return total;
+}
+
+
+int64_t posicionMaximaEscalar(const float *notas, const int64_t n) {
+    if (n == 0) return -1;
+    int64_t max = 0;
+    for (int64_t i = 1; i < n; i++) {
+        if (notas[i] > notas[max]) max = i;
+    }
+    return max;
+}
+
+
+// Las variantes vectoriales de posicionMaxima llevan en cada carril la
+// posición de su máximo en enteros de 32 bits, así que recorren la
+// columna por tramos de como mucho MAX_TRAMO_POSICIONES notas
+const int64_t MAX_TRAMO_POSICIONES = int64_t{1} << 30;
+
+
+/**
+ * Combina el máximo de cada carril de una variante vectorial, quedándose
+ * con la primera posición si hay empate, y sigue con las notas que no
+ * llenaban un vector
+ * @param notas Columna de notas del tramo
+ * @param n Número de notas del tramo
+ * @param i Primera posición que no se ha recorrido con vectores
+ * @param posiciones Posición del máximo de cada carril
+ * @param carriles Número de carriles
+ * @return Primera posición con la nota más alta del tramo
+ */
+int64_t reducirCarriles(const float *notas, const int64_t n, int64_t i, const int32_t *posiciones,
+                        const int carriles) {
+    int64_t max = posiciones[0];
+    for (int c = 1; c < carriles; c++) {
+        if (notas[posiciones[c]] > notas[max] or (notas[posiciones[c]] == notas[max] and posiciones[c] < max)) {
+            max = posiciones[c];
+        }
+    }
+    for (; i < n; i++) {
+        if (notas[i] > notas[max]) max = i;
+    }
+    return max;
+}
+
+
+/**
+ * Aplica por tramos una variante vectorial de posicionMaxima a una columna
+ * que puede tener más de MAX_TRAMO_POSICIONES notas
+ * @param notas Columna de notas
+ * @param n Número de notas
+ * @param tramo Variante para un tramo
+ * @return Primera posición con la nota más alta o -1 si n es 0
+ */
+int64_t posicionMaximaPorTramos(const float *notas, const int64_t n, int64_t (*tramo)(const float *, int64_t)) {
+    int64_t max = -1;
+    for (int64_t inicio = 0; inicio < n; inicio += MAX_TRAMO_POSICIONES) {
+        const int64_t posicion = inicio + tramo(notas + inicio, min(MAX_TRAMO_POSICIONES, n - inicio));
+        if (max == -1 or notas[posicion] > notas[max]) max = posicion;
+    }
+    return max;
+}
+
+
+#ifdef PARCIAL_SIMD_X86
+DESTINO_SIMD("sse4.2")
+double sumarNotasSSE42(const float *notas, const int64_t n) {
+    __m128d suma0 = _mm_setzero_pd(), suma1 = _mm_setzero_pd();
+    int64_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        const __m128 v = _mm_loadu_ps(notas + i);
+        suma0 = _mm_add_pd(suma0, _mm_cvtps_pd(v));
+        suma1 = _mm_add_pd(suma1, _mm_cvtps_pd(_mm_movehl_ps(v, v)));
+    }
+    double partes[2];
+    _mm_storeu_pd(partes, _mm_add_pd(suma0, suma1));
+    return partes[0] + partes[1] + sumarNotasEscalar(notas + i, n - i);
+}
+
+
+DESTINO_SIMD("sse4.2")
+int64_t contarMenoresSSE42(const float *notas, const int64_t n, const float umbral) {
+    const __m128 u = _mm_set1_ps(umbral);
+    int64_t total = 0, i = 0;
+    for (; i + 4 <= n; i += 4) {
+        total += popcount(static_cast<unsigned>(_mm_movemask_ps(_mm_cmplt_ps(_mm_loadu_ps(notas + i), u))));
+    }
+    return total + contarMenoresEscalar(notas + i, n - i, umbral);
+}
+
+
+DESTINO_SIMD("sse4.2")
+int64_t posicionMaximaTramoSSE42(const float *notas, const int64_t n) {
+    if (n < 4) return posicionMaximaEscalar(notas, n);
+    __m128 max = _mm_loadu_ps(notas);
+    __m128i posicion = _mm_setr_epi32(0, 1, 2, 3), posicionMax = posicion;
+    const __m128i paso = _mm_set1_epi32(4);
+    int64_t i = 4;
+    for (; i + 4 <= n; i += 4) {
+        const __m128 v = _mm_loadu_ps(notas + i);
+        const __m128 mayor = _mm_cmpgt_ps(v, max);
+        posicion = _mm_add_epi32(posicion, paso);
+        max = _mm_blendv_ps(max, v, mayor);
+        posicionMax = _mm_blendv_epi8(posicionMax, posicion, _mm_castps_si128(mayor));
+    }
+    int32_t posiciones[4];
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(posiciones), posicionMax);
+    return reducirCarriles(notas, n, i, posiciones, 4);
+}
+
+
+int64_t posicionMaximaSSE42(const float *notas, const int64_t n) {
+    return posicionMaximaPorTramos(notas, n, posicionMaximaTramoSSE42);
+}
+
+
+DESTINO_SIMD("avx2")
+double sumarNotasAVX2(const float *notas, const int64_t n) {
+    __m256d suma0 = _mm256_setzero_pd(), suma1 = _mm256_setzero_pd();
+    int64_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        suma0 = _mm256_add_pd(suma0, _mm256_cvtps_pd(_mm_loadu_ps(notas + i)));
+        suma1 = _mm256_add_pd(suma1, _mm256_cvtps_pd(_mm_loadu_ps(notas + i + 4)));
+    }
+    double partes[4];
+    _mm256_storeu_pd(partes, _mm256_add_pd(suma0, suma1));
+    return partes[0] + partes[1] + partes[2] + partes[3] + sumarNotasEscalar(notas + i, n - i);
+}
+
+
+DESTINO_SIMD("avx2")
+int64_t contarMenoresAVX2(const float *notas, const int64_t n, const float umbral) {
+    const __m256 u = _mm256_set1_ps(umbral);
+    int64_t total = 0, i = 0;
+    for (; i + 8 <= n; i += 8) {
+        const __m256 menores = _mm256_cmp_ps(_mm256_loadu_ps(notas + i), u, _CMP_LT_OQ);
+        total += popcount(static_cast<unsigned>(_mm256_movemask_ps(menores)));
+    }
+    return total + contarMenoresEscalar(notas + i, n - i, umbral);
+}
+
+
+DESTINO_SIMD("avx2")
+int64_t posicionMaximaTramoAVX2(const float *notas, const int64_t n) {
+    if (n < 8) return posicionMaximaEscalar(notas, n);
+    __m256 max = _mm256_loadu_ps(notas);
+    __m256i posicion = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7), posicionMax = posicion;
+    const __m256i paso = _mm256_set1_epi32(8);
+    int64_t i = 8;
+    for (; i + 8 <= n; i += 8) {
+        const __m256 v = _mm256_loadu_ps(notas + i);
+        const __m256 mayor = _mm256_cmp_ps(v, max, _CMP_GT_OQ);
+        posicion = _mm256_add_epi32(posicion, paso);
+        max = _mm256_blendv_ps(max, v, mayor);
+        posicionMax = _mm256_blendv_epi8(posicionMax, posicion, _mm256_castps_si256(mayor));
+    }
+    int32_t posiciones[8];
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(posiciones), posicionMax);
+    return reducirCarriles(notas, n, i, posiciones, 8);
+}
+
+
+int64_t posicionMaximaAVX2(const float *notas, const int64_t n) {
+    return posicionMaximaPorTramos(notas, n, posicionMaximaTramoAVX2);
+}
+
+
+// Las variantes AVX-512 usan las versiones con máscara de las conversiones
+// y del máximo y reducen en memoria: las demás dan avisos falsos de
+// variables sin inicializar en las cabeceras de GCC 12
+DESTINO_SIMD("avx512f")
+double sumarNotasAVX512(const float *notas, const int64_t n) {
+    __m512d suma0 = _mm512_setzero_pd(), suma1 = _mm512_setzero_pd();
+    int64_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        suma0 = _mm512_add_pd(suma0, _mm512_maskz_cvtps_pd(0xFF, _mm256_loadu_ps(notas + i)));
+        suma1 = _mm512_add_pd(suma1, _mm512_maskz_cvtps_pd(0xFF, _mm256_loadu_ps(notas + i + 8)));
+    }
+    double partes[8];
+    _mm512_storeu_pd(partes, _mm512_add_pd(suma0, suma1));
+    double suma = sumarNotasEscalar(notas + i, n - i);
+    for (const double parte: partes) suma += parte;
+    return suma;
+}
+
+
+DESTINO_SIMD("avx512f")
+int64_t contarMenoresAVX512(const float *notas, const int64_t n, const float umbral) {
+    const __m512 u = _mm512_set1_ps(umbral);
+    int64_t total = 0, i = 0;
+    for (; i + 16 <= n; i += 16) {
+        total += popcount(static_cast<unsigned>(_mm512_cmp_ps_mask(_mm512_loadu_ps(notas + i), u, _CMP_LT_OQ)));
+    }
+    return total + contarMenoresEscalar(notas + i, n - i, umbral);
+}
+
+
+DESTINO_SIMD("avx512f")
+int64_t posicionMaximaTramoAVX512(const float *notas, const int64_t n) {
+    if (n < 16) return posicionMaximaEscalar(notas, n);
+    __m512 max = _mm512_loadu_ps(notas);
+    __m512i posicion = _mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+    __m512i posicionMax = posicion;
+    const __m512i paso = _mm512_set1_epi32(16);
+    int64_t i = 16;
+    for (; i + 16 <= n; i += 16) {
+        const __m512 v = _mm512_loadu_ps(notas + i);
+        const __mmask16 mayor = _mm512_cmp_ps_mask(v, max, _CMP_GT_OQ);
+        posicion = _mm512_add_epi32(posicion, paso);
+        max = _mm512_mask_mov_ps(max, mayor, v);
+        posicionMax = _mm512_mask_mov_epi32(posicionMax, mayor, posicion);
+    }
+    int32_t posiciones[16];
+    _mm512_storeu_si512(posiciones, posicionMax);
+    return reducirCarriles(notas, n, i, posiciones, 16);
+}
+
+
+int64_t posicionMaximaAVX512(const float *notas, const int64_t n) {
+    return posicionMaximaPorTramos(notas, n, posicionMaximaTramoAVX512);
+}
+
+
+const KernelsNotas VARIANTES_KERNELS[NUM_VARIANTES_SIMD] = {
+    {"escalar", sumarNotasEscalar, contarMenoresEscalar, posicionMaximaEscalar},
+    {"sse4.2", sumarNotasSSE42, contarMenoresSSE42, posicionMaximaSSE42},
+    {"avx2", sumarNotasAVX2, contarMenoresAVX2, posicionMaximaAVX2},
+    {"avx512", sumarNotasAVX512, contarMenoresAVX512, posicionMaximaAVX512},
+};
+#else
+const KernelsNotas VARIANTES_KERNELS[NUM_VARIANTES_SIMD] = {
+    {"escalar", sumarNotasEscalar, contarMenoresEscalar, posicionMaximaEscalar},
+    {"sse4.2", sumarNotasEscalar, contarMenoresEscalar, posicionMaximaEscalar},
+    {"avx2", sumarNotasEscalar, contarMenoresEscalar, posicionMaximaEscalar},
+    {"avx512", sumarNotasEscalar, contarMenoresEscalar, posicionMaximaEscalar},
+};
+#endif
+
+
+/**
+ * Comprueba con CPUID si el procesador y el sistema operativo admiten las
+ * instrucciones de una variante (para AVX, que el sistema guarda sus registros)
+ * @param variante Variante a comprobar
+ * @return Verdadero si la variante se puede usar en esta máquina
+ */
+bool soportaVariante(const VarianteSimd variante) {
+    if (variante == SIMD_ESCALAR) return true;
+#if defined(PARCIAL_SIMD_X86) && defined(__GNUC__)
+    __builtin_cpu_init();
+    switch (variante) {
+        case SIMD_SSE42: return __builtin_cpu_supports("sse4.2");
+        case SIMD_AVX2: return __builtin_cpu_supports("avx2");
+        case SIMD_AVX512: return __builtin_cpu_supports("avx512f");
+        default: return false;
+    }
+#elif defined(PARCIAL_SIMD_X86)
+    int registros[4];
+    __cpuid(registros, 0);
+    const int maximo = registros[0];
+    __cpuid(registros, 1);
+    const bool sse42 = registros[2] & (1 << 20);
+    const bool avxSistema = (registros[2] & (1 << 27)) and (registros[2] & (1 << 28)) and (_xgetbv(0) & 0x6) == 0x6;
+    if (variante == SIMD_SSE42) return sse42;
+    if (not avxSistema or maximo < 7) return false;
+    __cpuidex(registros, 7, 0);
+    if (variante == SIMD_AVX2) return registros[1] & (1 << 5);
+    return (registros[1] & (1 << 16)) and (_xgetbv(0) & 0xE6) == 0xE6;
+#else
+    return false;
+#endif
+}
+
+
+/**
+ * @return La variante con más instrucciones vectoriales que admite esta máquina
+ */
+VarianteSimd getMejorVariante() {
+    for (int v = NUM_VARIANTES_SIMD - 1; v > SIMD_ESCALAR; v--) {
+        if (soportaVariante(static_cast<VarianteSimd>(v))) return static_cast<VarianteSimd>(v);
+    }
+    return SIMD_ESCALAR;
+}
+
+
+// Recorridos de notas en uso: la mejor variante de la máquina, salvo que
+// se fuerce otra con --simd
+const KernelsNotas *kernelsNotas = &VARIANTES_KERNELS[getMejorVariante()];
+
+
+/**
+ * Fuerza la variante de los recorridos de notas por su nombre
+ * @param nombre escalar, sse4.2, avx2 o avx512
+ * @return Verdadero si la variante existe y esta máquina la admite
+ */
+bool forzarVarianteSimd(const string_view nombre) {
+    for (int v = 0; v < NUM_VARIANTES_SIMD; v++) {
+        if (nombre == VARIANTES_KERNELS[v].nombre and soportaVariante(static_cast<VarianteSimd>(v))) {
+            kernelsNotas = &VARIANTES_KERNELS[v];
+            return true;
+        }
+    }
+    return false;
+}
+
+
+/**
+ * Estructura Alumno para manejar los datos de un alumno
+ * Consta de un campo "nombre" de tipo string
+ * y campo "nota" de tipo float
+ * El texto del nombre se reserva en el recurso de memoria con el que se
+ * crea el alumno, normalmente el de la lista a la que pertenece
+ */
+struct Alumno {
+    pmr::string nombre; // Campo nombre (string)
+    float nota; // Campo nota (float)
+};
+
+
+/**
+ * Deja una nota 0 siempre como +0: -0 es una nota válida (es igual a 0)
+ * pero se imprimiría como -0 y su patrón de bits no ordena como 0
+ * @param nota Nota a normalizar
+ * @return La misma nota, con +0 en lugar de -0
+ */
+inline float normalizarNota(const float nota) {
+    return nota == 0 ? 0.0f : nota;
+}
+
+
+/**
+ * Crea un alumno por valor con su nombre reservado en un recurso de memoria
+ * El alumno es de quien lo recibe: se mueve a una lista con addAlumno y,
+ * si no llega a añadirse, libera su nombre él solo al destruirse
+ * @param recurso Recurso de memoria de donde sale el nombre del alumno
+ * @param nombre Nombre del alumno
+ * @param nota Nota del alumno
+ * @return El alumno creado
+ */
+Alumno crearAlumno(pmr::memory_resource *recurso, const string_view nombre, const float nota) {
+    return Alumno{pmr::string(nombre, recurso), normalizarNota(nota)};
+}
+
+
+/**
+ * Comprueba si una nota es válida: un valor entre 0 y 10
+ * @param nota Nota a comprobar
+ * @return Verdadero si la nota es válida
+ */
+inline bool esNotaValida(const float nota) {
+    return nota >= 0 and nota <= 10;
+}
+
+
+/**
+ * Comprueba si un nombre de alumno es válido: no puede estar vacío
+ * @param nombre Nombre a comprobar
+ * @return Verdadero si el nombre es válido
+ */
+inline bool esNombreValido(const string_view nombre) {
+    return not nombre.empty();
+}
+
+
+/**
+ * Pide la nota del alumno mediante entrada por teclado
+ * Comprueba que la nota está entre 0 y 10 y si no es así
+ * vuelve a pedir al usuario la introducción de la nota
+ * @return Un valor entre 0 y 10, correspondiente a una nota numérica
+ */
+float inputNota() {
+    MEDIR_OPERACION(OP_INPUT_NOTA);
+    float nota;
+    do {
+        std::cout << "Introduce una nota numerica de 0 a 10:";
+        cin >> nota;
+    } while (not esNotaValida(nota));
+    return nota;
+}
+
+
+/**
+ * Pide el nombre y apellidos del alumno mediante entrada por teclado
+ * Comprueba que el texto no esté vacío, de lo contrario
+ * vuelve a pedir al usuario la introducción del dato
+ * @return Un string con el nombre y apellidos
+ */
+string inputNombre() {
+    MEDIR_OPERACION(OP_INPUT_NOMBRE);
+    string nombre;
+    do {
+        cout << "Introduce un nombre para el alumno:";
+        getline(cin, nombre);
+        if (not esNombreValido(nombre)) {
+            cout << "El nombre no puede quedar vacio!!!\n";
+        }
+    } while (not esNombreValido(nombre));
+    return nombre;
+}
+
+
+/**
+ * Apoyándose en los métodos inputNota e inputNombre
+ * obtiene los datos de un alumno: nombre y nota para crear una
+ * estructura Alumno por valor, con sus campos nombre y nota
+ * inicializados con los datos introducidos por el usuario
+ * @param recurso Recurso de memoria de donde sale el nombre del alumno
+ * @return El alumno, que se mueve a la lista al añadirlo
+ */
+Alumno inputAlumno(pmr::memory_resource *recurso = pmr::get_default_resource()) {
+    MEDIR_OPERACION(OP_INPUT_ALUMNO);
+    cout << "Introduce datos del alumno...\n";
+    const string nombre = inputNombre();
+    const float nota = inputNota();
+    return crearAlumno(recurso, nombre, nota);
+}
+
+
+/**
+ * Abre un fichero para añadir datos al final, creándolo si no existe
+ * @param ruta Ruta del fichero
+ * @return Descriptor del fichero o -1 si no se ha podido abrir
+ */
+int abrirParaAnadir(const string &ruta) {
+#ifdef _WIN32
+    return _open(ruta.c_str(), _O_WRONLY | _O_CREAT | _O_APPEND | _O_BINARY, 0644);
+#else
+    return open(ruta.c_str(), O_WRONLY | O_CREAT | O_APPEND, 0644);
+#endif
+}
+
+
+/**
+ * Crea un fichero vacío (o vacía uno existente) para escribir en él
+ * @param ruta Ruta del fichero
+ * @return Descriptor del fichero o -1 si no se ha podido abrir
+ */
+int abrirParaEscribir(const string &ruta) {
+#ifdef _WIN32
+    return _open(ruta.c_str(), _O_WRONLY | _O_CREAT | _O_TRUNC | _O_BINARY, 0644);
+#else
+    return open(ruta.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+#endif
+}
+
+
+/**
+ * Abre un fichero existente para leerlo
+ * @param ruta Ruta del fichero
+ * @return Descriptor del fichero o -1 si no se ha podido abrir
+ */
+int abrirParaLeer(const string &ruta) {
+#ifdef _WIN32
+    return _open(ruta.c_str(), _O_RDONLY | _O_BINARY);
+#else
+    return open(ruta.c_str(), O_RDONLY);
+#endif
+}
+
+
+/**
+ * Obtiene el tamaño de un fichero abierto
+ * @param fd Descriptor del fichero
+ * @return Tamaño en bytes o -1 si no se ha podido consultar
+ */
+int64_t getTamFichero(const int fd) {
+#ifdef _WIN32
+    struct _stat64 estado{};
+    if (_fstat64(fd, &estado) != 0) return -1;
+#else
+    struct stat estado{};
+    if (fstat(fd, &estado) != 0) return -1;
+#endif
+    return static_cast<int64_t>(estado.st_size);
+}
+
+
+/**
+ * Recorta un fichero abierto para escribir al tamaño indicado
+ * @param fd Descriptor del fichero
+ * @param tam Tamaño que tendrá el fichero
+ * @return Verdadero si se ha podido recortar
+ */
+bool recortarFichero(const int fd, const int64_t tam) {
+#ifdef _WIN32
+    return _chsize_s(fd, tam) == 0;
+#else
+    return ftruncate(fd, static_cast<off_t>(tam)) == 0;
+#endif
+}
+
+
+/**
+ * Lee bytes de una posición concreta de un fichero sin depender de la
+ * posición actual de lectura, de modo que varias lecturas pueden hacerse
+ * sin coordinarse entre sí
+ * @param fd Descriptor del fichero
+ * @param posicion Posición del primer byte a leer
+ * @param destino Buffer donde dejar los bytes
+ * @param n Número de bytes a leer
+ * @return Verdadero si se han leído los n bytes
+ */
+bool leerEn(const int fd, uint64_t posicion, char *destino, size_t n) {
+#ifdef _WIN32
+    static mutex cerrojo; // _lseeki64 y _read comparten la posición del descriptor
+    lock_guard<mutex> bloqueo(cerrojo);
+    if (_lseeki64(fd, static_cast<__int64>(posicion), SEEK_SET) < 0) return false;
+#endif
+    while (n > 0) {
+#ifdef _WIN32
+        const int leidos = _read(fd, destino, static_cast<unsigned>(min<size_t>(n, 1 << 30)));
+#else
+        const ssize_t leidos = pread(fd, destino, n, static_cast<off_t>(posicion));
+#endif
+        if (leidos < 0 and errno == EINTR) continue;
+        if (leidos <= 0) return false;
+        destino += leidos;
+        posicion += leidos;
+        n -= leidos;
+    }
+    return true;
+}
+
+
+/**
+ * Lee como mucho n bytes de la posición actual de un descriptor de fichero
+ * Si una señal interrumpe la lectura antes de leer nada, se repite
+ * @return Bytes leídos, 0 al final del fichero o negativo si hay un error
+ */
+int64_t leerFichero(const int fd, char *destino, const size_t n) {
+#ifdef _WIN32
+    return _read(fd, destino, static_cast<unsigned>(min<size_t>(n, 1 << 30)));
+#else
+    ssize_t leidos;
+    do {
+        leidos = read(fd, destino, n);
+    } while (leidos < 0 and errno == EINTR);
+    return leidos;
+#endif
+}
+
+
+/**
+ * Fichero completo accesible en memoria. En sistemas POSIX se proyecta
+ * con mmap, de modo que se lee según se accede a él; en Windows se lee
+ * entero a un buffer
+ */
+struct FicheroMapeado {
+    const char *datos;
+    size_t tam;
+#ifdef _WIN32
+    vector<char> buffer;
+#endif
+};
+
+
+/**
+ * Proyecta un fichero en memoria para leerlo
+ * @param ruta Ruta del fichero
+ * @return Puntero al fichero mapeado o nulo si no se ha podido abrir
+ */
+FicheroMapeado *mapearFichero(const string &ruta) {
+    FicheroMapeado *fichero = new FicheroMapeado{nullptr, 0};
+#ifdef _WIN32
+    ifstream entrada(ruta, ios::binary);
+    if (not entrada) {
+        delete fichero;
+        return nullptr;
+    }
+    fichero->buffer.assign(istreambuf_iterator<char>(entrada), istreambuf_iterator<char>());
+    fichero->datos = fichero->buffer.data();
+    fichero->tam = fichero->buffer.size();
+#else
+    const int fd = open(ruta.c_str(), O_RDONLY);
+    struct stat estado{};
+    if (fd < 0 or fstat(fd, &estado) != 0) {
+        if (fd >= 0) close(fd);
+        delete fichero;
+        return nullptr;
+    }
+    fichero->tam = static_cast<size_t>(estado.st_size);
+    if (fichero->tam > 0) {
+        void *datos = mmap(nullptr, fichero->tam, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (datos == MAP_FAILED) {
+            close(fd);
+            delete fichero;
+            return nullptr;
+        }
+        madvise(datos, fichero->tam, MADV_SEQUENTIAL);
+        fichero->datos = static_cast<const char *>(datos);
+    }
+    close(fd); // La proyección sigue siendo válida sin el descriptor
+#endif
+    return fichero;
+}
+
+
+/**
+ * Deshace la proyección de un fichero y libera la estructura
+ * @param fichero Puntero a una estructura de tipo FicheroMapeado
+ */
+void desmapearFichero(FicheroMapeado *fichero) {
+    if (fichero == nullptr) return;
+#ifndef _WIN32
+    if (fichero->tam > 0) munmap(const_cast<char *>(fichero->datos), fichero->tam);
+#endif
+    delete fichero;
+}
+
+
+/**
+ * Escribe todos los bytes indicados en un descriptor de fichero,
+ * repitiendo la escritura si el sistema escribe solo una parte o si una
+ * señal la interrumpe
+ * @return Verdadero si se han escrito todos los bytes
+ */
+bool escribirTodo(const int fd, const char *datos, size_t n) {
+    while (n > 0) {
+#ifdef _WIN32
+        const int escritos = _write(fd, datos, static_cast<unsigned>(n));
+#else
+        const ssize_t escritos = write(fd, datos, n);
+#endif
+        if (escritos < 0 and errno == EINTR) continue;
+        if (escritos <= 0) return false;
+        datos += escritos;
+        n -= escritos;
+    }
+    return true;
+}
+
+
+#ifdef _WIN32
+/**
+ * Trozo de memoria de una escritura vectorial, como el iovec de POSIX
+ */
+struct iovec {
+    void *iov_base;
+    size_t iov_len;
+};
+#endif
+
+// Trozos que se pasan como mucho a cada llamada a writev
+#ifdef IOV_MAX
+const size_t MAX_TROZOS_ESCRITURA = IOV_MAX;
+#else
+const size_t MAX_TROZOS_ESCRITURA = 1024;
+#endif
+
+
+/**
+ * Escribe seguidos varios trozos de memoria en un descriptor de fichero
+ * con el menor número de llamadas al sistema (writev), repitiendo la
+ * escritura si el sistema escribe solo una parte. En Windows, que no
+ * tiene writev, se escriben uno a uno
+ * @param fd Descriptor del fichero
+ * @param vectores Trozos a escribir; se modifican durante la escritura
+ * @param num Número de trozos
+ * @return Verdadero si se han escrito todos los bytes
+ */
+bool escribirVectores(const int fd, iovec *vectores, size_t num) {
+#ifdef _WIN32
+    for (size_t i = 0; i < num; i++) {
+        if (not escribirTodo(fd, static_cast<const char *>(vectores[i].iov_base), vectores[i].iov_len)) return false;
+    }
+    return true;
+#else
+    while (num > 0) {
+        ssize_t escritos = writev(fd, vectores, static_cast<int>(min(num, MAX_TROZOS_ESCRITURA)));
+        if (escritos < 0 and errno == EINTR) continue;
+        if (escritos <= 0) return false;
+        while (num > 0 and static_cast<size_t>(escritos) >= vectores->iov_len) {
+            escritos -= static_cast<ssize_t>(vectores->iov_len);
+            vectores++;
+            num--;
+        }
+        if (num > 0) {
+            vectores->iov_base = static_cast<char *>(vectores->iov_base) + escritos;
+            vectores->iov_len -= escritos;
+        }
+    }
+    return true;
+#endif
+}
+
+/**
+ * Fuerza que los datos escritos en el descriptor lleguen al disco
+ * @return Verdadero si la sincronización ha tenido éxito
+ */
+bool sincronizarDisco(const int fd) {
+#ifdef _WIN32
+    return _commit(fd) == 0;
+#else
+    return fsync(fd) == 0;
+#endif
+}
+
+
+/**
+ * Cierra un descriptor de fichero
+ */
+void cerrarFichero(const int fd) {
+#ifdef _WIN32
+    _close(fd);
+#else
+    close(fd);
+#endif
+}
+
+
+/**
+ * Sincroniza con el disco el directorio que contiene un fichero para que
+ * las creaciones, renombrados y borrados de ficheros sean duraderos
+ * (no es necesario en Windows)
+ * @param ruta Ruta de un fichero del directorio
+ */
+void sincronizarDirectorio(const string &ruta) {
+#ifndef _WIN32
+    const filesystem::path directorio = filesystem::path(ruta).parent_path();
+    const int fd = open(directorio.empty() ? "." : directorio.c_str(), O_RDONLY);
+    if (fd < 0) return;
+    fsync(fd);
+    close(fd);
+#else
+    (void) ruta;
+#endif
+}
+
+
+/**
+ * Tabla del CRC-32 (polinomio 0xEDB88320) calculada en compilación
+ */
+constexpr array<uint32_t, 256> TABLA_CRC32 = [] {
+    array<uint32_t, 256> tabla{};
+    for (uint32_t i = 0; i < 256; i++) {
+        uint32_t c = i;
+        for (int k = 0; k < 8; k++) c = c & 1 ? 0xEDB88320u ^ c >> 1 : c >> 1;
+        tabla[i] = c;
+    }
+    return tabla;
+}();
+
+
+/**
+ * Calcula el CRC-32 de un bloque de bytes
+ * @param datos Puntero al primer byte
+ * @param n Número de bytes
+ * @param anterior CRC de los bytes anteriores si el bloque continúa
+ * otro, de modo que se pueda calcular por partes
+ * @return Suma de comprobación CRC-32
+ */
+uint32_t calcularCrc32(const char *datos, const size_t n, const uint32_t anterior = 0) {
+    uint32_t crc = anterior ^ 0xFFFFFFFFu;
+    for (size_t i = 0; i < n; i++) crc = TABLA_CRC32[(crc ^ static_cast<uint8_t>(datos[i])) & 0xFF] ^ crc >> 8;
+    return crc ^ 0xFFFFFFFFu;
+}
+
+
+/**
+ * Añade al final de un string la representación binaria de un valor
+ * (en el orden de bytes de la máquina)
+ */
+template<typename T>
+void escribirBinario(string &destino, const T valor) {
+    destino.append(reinterpret_cast<const char *>(&valor), sizeof(T));
+}
+
+
+/**
+ * Lee un valor binario de un buffer avanzando la posición de lectura
+ * @return Verdadero si había bytes suficientes para leer el valor
+ */
+template<typename T>
+bool leerBinario(const char *&datos, const char *fin, T &valor) {
+    if (fin - datos < static_cast<ptrdiff_t>(sizeof(T))) return false;
+    memcpy(&valor, datos, sizeof(T));
+    datos += sizeof(T);
+    return true;
+}
+
+
+/**
+ * Tipos de operación que se registran en el diario
+ */
+enum TipoRegistro : uint8_t {
+    REGISTRO_CREAR_CURSO = 1, // id, capacidad, nombre y tipo de recurso del curso
+    REGISTRO_ELIMINAR_CURSO = 2, // id
+    REGISTRO_ALTA_ALUMNO = 3 // id del curso, nota, nombre del alumno
+};
+
+// Bytes pendientes a partir de los cuales se escribe el lote sin esperar
+// a que termine la ventana de durabilidad
+const size_t TAM_LOTE_DIARIO = 1 << 20;
+
+
+/**
+ * Diario de escritura anticipada (write-ahead log) de las operaciones que
+ * modifican los cursos. Cada registro del fichero tiene la forma
+ * [longitud u32][tipo u8][lsn u64][datos][crc32 u32], donde la longitud
+ * cuenta tipo, lsn y datos y el CRC se calcula sobre esos mismos bytes
+ *
+ * Los registros se acumulan en memoria (campo pendiente) y un hilo los
+ * escribe y sincroniza con el disco en grupo cada ventanaMs milisegundos
+ * o antes si el lote supera TAM_LOTE_DIARIO, de modo que un fsync da por
+ * duraderas muchas inserciones. Con ventanaMs igual a 0 no hay hilo y cada
+ * operación se sincroniza antes de volver
+ *
+ * El diario se divide en segmentos numerados por generación: el de la
+ * generación 0 es el fichero rutaBase y los siguientes rutaBase.<generación>
+ * Cada punto de control abre un segmento nuevo y, cuando la imagen del
+ * catálogo ya está en disco, borra los segmentos anteriores
+ */
+struct Diario {
+    string rutaBase;
+    uint64_t generacion; // Generación del segmento en el que se escribe
+    int fd;
+    int ventanaMs; // Ventana de durabilidad: operaciones que se pueden perder
+    mutex cerrojo; // Protege pendiente, siguienteLsn, terminar y error
+    mutex cerrojoFichero; // Serializa las escrituras en el fichero
+    condition_variable aviso;
+    string pendiente; // Registros aún no escritos en el fichero
+    uint64_t siguienteLsn; // Número de secuencia del siguiente registro
+    bool terminar;
+    bool error; // Ha fallado una escritura: el diario ya no admite registros
+    thread sincronizador;
+    uint64_t registrosPuntoControl; // Registros añadidos desde el último punto de control
+    atomic<bool> puntoControlEnCurso;
+    thread puntoControl; // Hilo que escribe la imagen del punto de control
+};
+
+
+/**
+ * @param rutaBase Ruta del diario indicada al arrancar
+ * @param generacion Generación del segmento
+ * @return Ruta del fichero del segmento de esa generación
+ */
+string getRutaSegmento(const string &rutaBase, const uint64_t generacion) {
+    return generacion == 0 ? rutaBase : rutaBase + "." + to_string(generacion);
+}
+
+
+/**
+ * @param rutaBase Ruta del diario indicada al arrancar
+ * @param generacion Generación del punto de control
+ * @return Ruta del fichero con la imagen del punto de control
+ */
+string getRutaPuntoControl(const string &rutaBase, const uint64_t generacion) {
+    return rutaBase + ".ckpt." + to_string(generacion);
+}
+
+
+/**
+ * Busca en el directorio del diario los ficheros cuyo nombre es el del
+ * diario seguido de un prefijo y un número de generación
+ * @param rutaBase Ruta del diario indicada al arrancar
+ * @param prefijo Texto entre el nombre del diario y la generación
+ * @return Generaciones encontradas en orden creciente
+ */
+vector<uint64_t> buscarGeneraciones(const string &rutaBase, const string &prefijo) {
+    vector<uint64_t> generaciones;
+    const filesystem::path base(rutaBase);
+    const filesystem::path directorio = base.parent_path().empty() ? "." : base.parent_path();
+    const string inicio = base.filename().string() + prefijo;
+    error_code error;
+    for (const auto &entrada: filesystem::directory_iterator(directorio, error)) {
+        const string nombre = entrada.path().filename().string();
+        if (nombre.size() <= inicio.size() or nombre.compare(0, inicio.size(), inicio) != 0) continue;
+        const string numero = nombre.substr(inicio.size());
+        if (numero.find_first_not_of("0123456789") != string::npos) continue;
+        generaciones.push_back(stoull(numero));
+    }
+    sort(generaciones.begin(), generaciones.end());
+    return generaciones;
+}
+
+
+/**
+ * Escribe en el fichero los registros pendientes del diario y los
+ * sincroniza con el disco con un único fsync
+ * Si la escritura falla, el fichero se recorta a su tamaño anterior para
+ * que no acabe en un registro a medias, el lote vuelve a quedar pendiente
+ * para reintentarlo en el siguiente volcado y el diario deja de admitir
+ * registros nuevos
+ * @param diario Puntero a una estructura de tipo Diario
+ */
+void volcarDiario(Diario *diario) {
+    lock_guard<mutex> escritura(diario->cerrojoFichero);
+    string lote;
+    {
+        lock_guard<mutex> bloqueo(diario->cerrojo);
+        lote.swap(diario->pendiente);
+    }
+    if (lote.empty()) return;
+    const int64_t tamAnterior = getTamFichero(diario->fd);
+    if (tamAnterior >= 0 and escribirTodo(diario->fd, lote.data(), lote.size()) and sincronizarDisco(diario->fd)) {
+        return;
+    }
+    if (tamAnterior >= 0) recortarFichero(diario->fd, tamAnterior);
+    lock_guard<mutex> bloqueo(diario->cerrojo);
+    if (not diario->error) cerr << "Error escribiendo el diario, no se admiten mas operaciones!!!" << endl;
+    diario->error = true;
+    diario->pendiente.insert(0, lote);
+}
+
+
+/**
+ * Comprueba si el diario ha dejado de admitir registros por un error de escritura
+ * @param diario Puntero a una estructura de tipo Diario
+ * @return Verdadero si ha fallado alguna escritura del diario
+ */
+bool hayErrorDiario(Diario *diario) {
+    lock_guard<mutex> bloqueo(diario->cerrojo);
+    return diario->error;
+}
+
+
+/**
+ * Función del hilo que hace el commit en grupo: espera a que termine la
+ * ventana de durabilidad o a que haya un lote grande y vuelca el diario
+ * @param diario Puntero a una estructura de tipo Diario
+ */
+void sincronizarDiarioPeriodicamente(Diario *diario) {
+    unique_lock<mutex> bloqueo(diario->cerrojo);
+    while (not diario->terminar) {
+        diario->aviso.wait_for(bloqueo, chrono::milliseconds(diario->ventanaMs), [diario] {
+            return diario->terminar or diario->pendiente.size() >= TAM_LOTE_DIARIO;
+        });
+        bloqueo.unlock();
+        volcarDiario(diario);
+        bloqueo.lock();
+    }
+}
+
+
+/**
+ * Abre (o crea) el segmento del diario en el que se seguirán añadiendo
+ * registros
+ * @param rutaBase Ruta del diario
+ * @param generacion Generación del segmento en el que se escribirá
+ * @param ventanaMs Milisegundos entre sincronizaciones, 0 para sincronizar
+ * cada operación
+ * @param siguienteLsn Número de secuencia que tendrá el primer registro nuevo
+ * @return Puntero al diario o nulo si no se ha podido abrir el fichero
+ */
+Diario *abrirDiario(const string &rutaBase, const uint64_t generacion, const int ventanaMs,
+                    const uint64_t siguienteLsn) {
+    const int fd = abrirParaAnadir(getRutaSegmento(rutaBase, generacion));
+    if (fd < 0) return nullptr;
+    Diario *diario = new Diario;
+    diario->rutaBase = rutaBase;
+    diario->generacion = generacion;
+    diario->fd = fd;
+    diario->ventanaMs = ventanaMs;
+    diario->siguienteLsn = siguienteLsn;
+    diario->terminar = false;
+    diario->error = false;
+    diario->registrosPuntoControl = 0;
+    diario->puntoControlEnCurso = false;
+    if (ventanaMs > 0) diario->sincronizador = thread(sincronizarDiarioPeriodicamente, diario);
+    return diario;
+}
+
+
+/**
+ * Espera a que termine de escribirse el punto de control en curso, si lo hay
+ * @param diario Puntero a una estructura de tipo Diario
+ */
+void esperarPuntoControl(Diario *diario) {
+    if (diario != nullptr and diario->puntoControl.joinable()) diario->puntoControl.join();
+}
+
+
+/**
+ * Vuelca los registros pendientes en el segmento actual y pasa a escribir
+ * en un segmento nuevo de la generación siguiente
+ * @param diario Puntero a una estructura de tipo Diario
+ * @return Verdadero si se ha podido abrir el segmento nuevo
+ */
+bool rotarDiario(Diario *diario) {
+    volcarDiario(diario);
+    lock_guard<mutex> escritura(diario->cerrojoFichero);
+    const int fd = abrirParaAnadir(getRutaSegmento(diario->rutaBase, diario->generacion + 1));
+    if (fd < 0) return false;
+    cerrarFichero(diario->fd);
+    diario->fd = fd;
+    diario->generacion++;
+    sincronizarDirectorio(diario->rutaBase);
+    return true;
+}
+
+
+/**
+ * Vuelca los registros pendientes, espera al punto de control en curso,
+ * detiene el hilo de sincronización, cierra el fichero y libera la
+ * memoria del diario
+ * @param diario Puntero a una estructura de tipo Diario
+ */
+void cerrarDiario(Diario *diario) {
+    if (diario == nullptr) return;
+    esperarPuntoControl(diario);
+    {
+        lock_guard<mutex> bloqueo(diario->cerrojo);
+        diario->terminar = true;
+    }
+    diario->aviso.notify_one();
+    if (diario->sincronizador.joinable()) diario->sincronizador.join();
+    volcarDiario(diario);
+    cerrarFichero(diario->fd);
+    delete diario;
+}
+
+
+/**
+ * Añade un registro al diario. Si la ventana de durabilidad es 0 el
+ * registro queda en disco al volver, si no se escribirá en el siguiente lote
+ * @param diario Puntero a una estructura de tipo Diario
+ * @param tipo Tipo de operación
+ * @param datos Datos de la operación ya codificados
+ * @return Falso si el diario no admite registros porque ha fallado una
+ * escritura anterior (o esta misma, con ventana 0)
+ */
+bool registrarOperacion(Diario *diario, const TipoRegistro tipo, const string &datos) {
+    bool loteLleno;
+    {
+        lock_guard<mutex> bloqueo(diario->cerrojo);
+        if (diario->error) return false;
+        string &pendiente = diario->pendiente;
+        const size_t inicio = pendiente.size();
+        escribirBinario<uint32_t>(pendiente, sizeof(uint8_t) + sizeof(uint64_t) + datos.size());
+        escribirBinario<uint8_t>(pendiente, tipo);
+        escribirBinario<uint64_t>(pendiente, diario->siguienteLsn++);
+        pendiente += datos;
+        const size_t cuerpo = inicio + sizeof(uint32_t);
+        escribirBinario<uint32_t>(pendiente, calcularCrc32(pendiente.data() + cuerpo, pendiente.size() - cuerpo));
+        diario->registrosPuntoControl++;
+        loteLleno = pendiente.size() >= TAM_LOTE_DIARIO;
+    }
+    if (diario->ventanaMs > 0) {
+        if (loteLleno) diario->aviso.notify_one();
+        return true;
+    }
+    volcarDiario(diario);
+    return not hayErrorDiario(diario);
+}
+
+
+/**
+ * Añade al diario el alta de un alumno en un curso
+ * @param diario Puntero a una estructura de tipo Diario
+ * @param idCurso Identificador del curso
+ * @param alumno Puntero a estructura constante de tipo Alumno
+ * @return Falso si el diario no admite registros
+ */
+bool registrarAltaAlumno(Diario *diario, const uint32_t idCurso, const Alumno *alumno) {
+    string datos;
+    escribirBinario<uint32_t>(datos, idCurso);
+    escribirBinario<float>(datos, alumno->nota);
+    escribirBinario<uint32_t>(datos, alumno->nombre.size());
+    datos += alumno->nombre;
+    return registrarOperacion(diario, REGISTRO_ALTA_ALUMNO, datos);
+}
+
+
+/**
+ * Comprueba si un string guarda su texto en memoria dinámica o si el texto
+ * cabe dentro del propio objeto string (optimización de cadenas cortas)
+ * @param texto Referencia constante al string
+ * @return Verdadero si el texto está en el heap
+ */
+inline bool usaMemoriaDinamica(const pmr::string &texto) {
+    const char *datos = texto.data();
+    const char *objeto = reinterpret_cast<const char *>(&texto);
+    return datos < objeto or datos >= objeto + sizeof(pmr::string);
+}
+
+
+/**
+ * Calcula un hash de 64 bits de un nombre (FNV-1a con una mezcla final
+ * para repartir bien todos los bits)
+ * @param nombre Texto del nombre
+ * @return Hash del nombre
+ */
+uint64_t calcularHashNombre(const string_view nombre) {
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    for (const char c: nombre) {
+        hash ^= static_cast<unsigned char>(c);
+        hash *= 0x100000001b3ULL;
+    }
+    hash ^= hash >> 33;
+    hash *= 0xff51afd7ed558ccdULL;
+    hash ^= hash >> 33;
+    hash *= 0xc4ceb9fe1a85ec53ULL;
+    hash ^= hash >> 33;
+    return hash;
+}
+
+
+// Bits de cada bloque del filtro de Bloom: una línea de caché de 64 bytes
+const uint32_t BITS_BLOQUE_BLOOM = 512;
+
+// Tasa de falsos positivos con la que se dimensionan los filtros de nombres de las listas
+double fprFiltroNombres = 0.01;
+
+// Nombres para los que se dimensiona al principio el filtro de nombres de una lista
+const int64_t NOMBRES_INICIALES_FILTRO = 1024;
+
+
+/**
+ * Estructura para manejar un filtro de Bloom por bloques
+ * Cada elemento marca sus numHashes bits dentro de un único bloque de
+ * BITS_BLOQUE_BLOOM bits, de modo que insertar o consultar un elemento
+ * solo toca una línea de caché
+ * El campo bloques apunta a numBloques bloques alineados a 64 bytes,
+ * dimensionados para el número de elementos del campo previstos
+ * Los campos consultas, descartes y falsosPositivos cuentan las consultas
+ * hechas, las que el filtro ha respondido que no (sin mirar nada más) y
+ * las que ha respondido que quizás y después resultaron no estar
+ */
+struct FiltroBloom {
+    uint64_t *bloques;
+    uint32_t numBloques;
+    int numHashes;
+    double fprObjetivo;
+    int64_t previstos;
+    int64_t insertados;
+    uint64_t consultas;
+    uint64_t descartes;
+    uint64_t falsosPositivos;
+    pmr::memory_resource *recurso; // Recurso de donde sale la memoria del filtro
+};
+
+
+/**
+ * Crea un filtro de Bloom vacío dimensionado para un número de elementos
+ * y una tasa de falsos positivos: m = -n ln(p) / ln(2)^2 bits y
+ * k = -log2(p) bits por elemento
+ * Al concentrar los bits de cada elemento en un bloque la tasa real es
+ * algo mayor que la de un filtro clásico del mismo tamaño, por lo que se
+ * reserva un 10 % más de bits
+ * @param elementos Número de elementos que se espera insertar
+ * @param fpr Tasa de falsos positivos deseada, entre 0 y 1
+ * @param recurso Recurso de memoria de donde sale la memoria del filtro
+ * @return Puntero a la estructura de tipo FiltroBloom creada
+ */
+FiltroBloom *crearFiltroBloom(const int64_t elementos, const double fpr,
+                              pmr::memory_resource *recurso = pmr::get_default_resource()) {
+    const double p = clamp(fpr, 1e-9, 0.5);
+    const double bits = 1.1 * static_cast<double>(max<int64_t>(elementos, 1)) * -log(p) / (log(2.0) * log(2.0));
+    FiltroBloom *filtro = pmr::polymorphic_allocator<>(recurso).new_object<FiltroBloom>();
+    filtro->recurso = recurso;
+    filtro->numBloques = static_cast<uint32_t>(
+        clamp(ceil(bits / BITS_BLOQUE_BLOOM), 1.0, static_cast<double>(UINT32_MAX)));
+    filtro->numHashes = clamp(static_cast<int>(lround(-log2(p))), 1, 16);
+    filtro->fprObjetivo = p;
+    filtro->previstos = max<int64_t>(elementos, 1);
+    const size_t bytes = static_cast<size_t>(filtro->numBloques) * BITS_BLOQUE_BLOOM / 8;
+    filtro->bloques = static_cast<uint64_t *>(recurso->allocate(bytes, 64));
+    memset(filtro->bloques, 0, bytes);
+    return filtro;
+}
+
+
+/**
+ * Libera la memoria de un filtro de Bloom
+ * @param filtro Puntero a una estructura de tipo FiltroBloom
+ */
+void destruirFiltroBloom(FiltroBloom *filtro) {
+    if (filtro == nullptr) return;
+    const size_t bytes = static_cast<size_t>(filtro->numBloques) * BITS_BLOQUE_BLOOM / 8;
+    filtro->recurso->deallocate(filtro->bloques, bytes, 64);
+    pmr::polymorphic_allocator<>(filtro->recurso).delete_object(filtro);
+}
+
+
+/**
+ * Calcula los bytes que ocupa un filtro de Bloom: la estructura y sus bloques
+ * @param filtro Puntero a una estructura constante de tipo FiltroBloom
+ * @return Bytes del filtro
+ */
+size_t getBytesFiltroBloom(const FiltroBloom *filtro) {
+    return sizeof(FiltroBloom) + static_cast<size_t>(filtro->numBloques) * BITS_BLOQUE_BLOOM / 8;
+}
+
+
+/**
+ * Devuelve el bloque del filtro que corresponde a un hash
+ * Usa los 32 bits altos del hash; los bits del elemento dentro del bloque
+ * salen de los 32 bits bajos
+ * @param filtro Puntero a una estructura constante de tipo FiltroBloom
+ * @param hash Hash del elemento
+ * @return Puntero a las 8 palabras de 64 bits del bloque
+ */
+inline uint64_t *getBloqueBloom(const FiltroBloom *filtro, const uint64_t hash) {
+    return filtro->bloques + ((hash >> 32) * filtro->numBloques >> 32) * (BITS_BLOQUE_BLOOM / 64);
+}
+
+
+/**
+ * Devuelve el salto entre los bits que marca un elemento dentro de su
+ * bloque. El primer bit sale de los bits 23 a 31 del hash y el bloque de
+ * los bits 32 a 63, así que el salto se forma con los bits 0 a 22, que no
+ * usa ninguno de los dos, para que no dependa de ellos
+ * @param hash Hash del elemento
+ * @return Salto, impar para que recorra posiciones distintas
+ */
+inline uint32_t getSaltoBloom(const uint64_t hash) {
+    return static_cast<uint32_t>(hash << 9) | 1;
+}
+
+
+/**
+ * Añade un elemento al filtro de Bloom marcando sus bits
+ * @param filtro Puntero a una estructura de tipo FiltroBloom
+ * @param hash Hash del elemento
+ */
+void insertarFiltroBloom(FiltroBloom *filtro, const uint64_t hash) {
+    uint64_t *bloque = getBloqueBloom(filtro, hash);
+    uint32_t bit = static_cast<uint32_t>(hash);
+    const uint32_t salto = getSaltoBloom(hash);
+    for (int i = 0; i < filtro->numHashes; i++, bit += salto) {
+        const uint32_t posicion = bit >> 23; // 9 bits: posición dentro del bloque
+        bloque[posicion / 64] |= 1ULL << (posicion % 64);
+    }
+    filtro->insertados++;
+}
+
+
+/**
+ * Consulta si un elemento puede estar en el filtro de Bloom
+ * Si devuelve false el elemento seguro que no se ha insertado; si
+ * devuelve true puede que sí o que sea un falso positivo
+ * @param filtro Puntero a una estructura constante de tipo FiltroBloom
+ * @param hash Hash del elemento
+ * @return false si el elemento seguro que no está
+ */
+bool puedeContener(const FiltroBloom *filtro, const uint64_t hash) {
+    const uint64_t *bloque = getBloqueBloom(filtro, hash);
+    uint32_t bit = static_cast<uint32_t>(hash);
+    const uint32_t salto = getSaltoBloom(hash);
+    for (int i = 0; i < filtro->numHashes; i++, bit += salto) {
+        const uint32_t posicion = bit >> 23;
+        if ((bloque[posicion / 64] & 1ULL << (posicion % 64)) == 0) return false;
+    }
+    return true;
+}
+
+
+/**
+ * Resumen del estado de un filtro de Bloom
+ */
+struct EstadisticasBloom {
+    size_t bytes; // Memoria de los bloques
+    int numHashes; // Bits marcados por elemento
+    int64_t insertados; // Elementos añadidos
+    double bitsPorElemento;
+    double ocupacion; // Fracción de bits a 1
+    double fprObjetivo; // Tasa de falsos positivos pedida al crear el filtro
+    double fprEstimada; // Tasa esperada con la ocupación actual de cada bloque
+    double fprMedida; // Falsos positivos entre las consultas de elementos que no estaban
+};
+
+
+/**
+ * Obtiene las estadísticas de un filtro de Bloom
+ * La tasa estimada es la media por bloques de (bits a 1 / bits del bloque)
+ * elevado al número de hashes, que tiene en cuenta que unos bloques se
+ * llenan más que otros
+ * @param filtro Puntero a una estructura constante de tipo FiltroBloom
+ * @return Estructura EstadisticasBloom con los datos calculados
+ */
+EstadisticasBloom getEstadisticasBloom(const FiltroBloom *filtro) {
+    EstadisticasBloom estadisticas{};
+    estadisticas.bytes = static_cast<size_t>(filtro->numBloques) * BITS_BLOQUE_BLOOM / 8;
+    estadisticas.numHashes = filtro->numHashes;
+    estadisticas.insertados = filtro->insertados;
+    estadisticas.fprObjetivo = filtro->fprObjetivo;
+    const double bitsTotales = static_cast<double>(estadisticas.bytes) * 8;
+    if (filtro->insertados > 0) estadisticas.bitsPorElemento = bitsTotales / static_cast<double>(filtro->insertados);
+    uint64_t unos = 0;
+    double sumaFpr = 0;
+    for (uint32_t b = 0; b < filtro->numBloques; b++) {
+        int unosBloque = 0;
+        for (uint32_t w = 0; w < BITS_BLOQUE_BLOOM / 64; w++) {
+            unosBloque += popcount(filtro->bloques[b * (BITS_BLOQUE_BLOOM / 64) + w]);
+        }
+        unos += unosBloque;
+        sumaFpr += pow(static_cast<double>(unosBloque) / BITS_BLOQUE_BLOOM, filtro->numHashes);
+    }
+    estadisticas.ocupacion = static_cast<double>(unos) / bitsTotales;
+    estadisticas.fprEstimada = sumaFpr / filtro->numBloques;
+    const uint64_t ausentes = filtro->descartes + filtro->falsosPositivos;
+    if (ausentes > 0) estadisticas.fprMedida = static_cast<double>(filtro->falsosPositivos) / ausentes;
+    return estadisticas;
+}
+
+
+/**
+ * Estructura para manejar un resumen KLL de una serie de notas, que
+ * permite calcular percentiles aproximados sin guardar todas las notas
+ * El campo niveles guarda en cada nivel h notas que representan a 2^h
+ * notas de la serie cada una. Cuando un nivel se llena se ordena y se pasa
+ * al nivel siguiente una de cada dos notas (las pares o las impares, al
+ * azar), de modo que el resumen ocupa O(k) notas sea cual sea la serie
+ * Con k = 200 el error en rango de un percentil es de alrededor del 1,65 %
+ * de las notas (con un 99 % de probabilidad): el percentil 90 devuelto
+ * está entre el 88,35 y el 91,65 real
+ * Dos resúmenes se pueden mezclar, de modo que cada curso o cada hilo
+ * puede llevar el suyo y combinarlos después con el mismo error
+ * Los niveles salen del recurso de memoria con el que se construyen los
+ * campos niveles y capacidades (el de la lista, en el resumen de una lista)
+ */
+struct SketchKLL {
+    int k; // Capacidad del nivel más alto; los inferiores tienen 2/3 de la del superior
+    pmr::vector<pmr::vector<float>> niveles;
+    pmr::vector<size_t> capacidades; // Notas que caben en cada nivel
+    size_t guardadas; // Notas guardadas en todos los niveles
+    size_t capacidad; // Suma de las capacidades de los niveles; al superarla se compacta
+    int64_t num; // Notas resumidas
+    float minimo;
+    float maximo;
+    uint64_t azar; // Estado del generador xorshift que decide qué mitad se conserva
+};
+
+// Parámetro k de los resúmenes de notas de las listas
+const int K_SKETCH_NOTAS = 200;
+
+
+/**
+ * Recalcula cuántas notas caben en cada nivel de un resumen KLL después de
+ * cambiar el número de niveles: k en el nivel más alto y 2/3 de las del
+ * nivel superior en los demás, con un mínimo de 8
+ * @param sketch Referencia al resumen
+ */
+void ajustarCapacidades(SketchKLL &sketch) {
+    const size_t numNiveles = sketch.niveles.size();
+    sketch.capacidades.resize(numNiveles);
+    sketch.capacidad = 0;
+    for (size_t h = 0; h < numNiveles; h++) {
+        const double profundidad = static_cast<double>(numNiveles - 1 - h);
+        sketch.capacidades[h] = max<size_t>(8, static_cast<size_t>(ceil(sketch.k * pow(2.0 / 3.0, profundidad))));
+        sketch.capacidad += sketch.capacidades[h];
+    }
+}
+
+
+/**
+ * Deja un resumen KLL vacío
+ * @param sketch Referencia al resumen
+ * @param k Parámetro de precisión, al menos 8
+ */
+void iniciarSketch(SketchKLL &sketch, const int k) {
+    sketch.k = max(8, k);
+    sketch.niveles.assign(1, {});
+    ajustarCapacidades(sketch);
+    sketch.guardadas = 0;
+    sketch.num = 0;
+    sketch.minimo = sketch.maximo = 0;
+    sketch.azar = 0x9e3779b97f4a7c15ULL;
+}
+
+
+/**
+ * Crea un resumen KLL vacío cuyos niveles salen de un recurso de memoria
+ * @param k Parámetro de precisión, al menos 8
+ * @param recurso Recurso de memoria de los niveles
+ * @return El resumen vacío
+ */
+SketchKLL crearSketch(const int k, pmr::memory_resource *recurso) {
+    SketchKLL sketch{k, pmr::vector<pmr::vector<float>>(recurso), pmr::vector<size_t>(recurso), 0, 0, 0, 0, 0, 0};
+    iniciarSketch(sketch, k);
+    return sketch;
+}
+
+
+/**
+ * Compacta un resumen KLL mientras tenga más notas de las que caben:
+ * ordena el nivel más bajo que esté lleno y pasa la mitad de sus notas al
+ * nivel siguiente, que tiene el doble de peso
+ * @param sketch Referencia al resumen
+ */
+void comprimirSketch(SketchKLL &sketch) {
+    while (sketch.guardadas > sketch.capacidad) {
+        size_t h = 0;
+        while (sketch.niveles[h].size() < sketch.capacidades[h]) h++;
+        if (h + 1 == sketch.niveles.size()) {
+            sketch.niveles.emplace_back();
+            ajustarCapacidades(sketch);
+        }
+        pmr::vector<float> &nivel = sketch.niveles[h];
+        pmr::vector<float> &superior = sketch.niveles[h + 1];
+        sort(nivel.begin(), nivel.end());
+        sketch.azar ^= sketch.azar << 13;
+        sketch.azar ^= sketch.azar >> 7;
+        sketch.azar ^= sketch.azar << 17;
+        const size_t pares = nivel.size() & ~static_cast<size_t>(1); // Si sobra una nota se queda en el nivel
+        for (size_t i = sketch.azar & 1; i < pares; i += 2) superior.push_back(nivel[i]);
+        nivel.erase(nivel.begin(), nivel.begin() + static_cast<ptrdiff_t>(pares));
+        sketch.guardadas -= pares / 2;
+    }
+}
+
+
+/**
+ * Añade una nota a un resumen KLL
+ * @param sketch Referencia al resumen
+ * @param nota Nota a añadir
+ */
+void actualizarSketch(SketchKLL &sketch, const float nota) {
+    if (sketch.num == 0 or nota < sketch.minimo) sketch.minimo = nota;
+    if (sketch.num == 0 or nota > sketch.maximo) sketch.maximo = nota;
+    sketch.num++;
+    sketch.niveles[0].push_back(nota);
+    if (++sketch.guardadas > sketch.capacidad) comprimirSketch(sketch);
+}
+
+
+/**
+ * Mezcla un resumen KLL en otro, que pasa a resumir las notas de los dos
+ * @param destino Referencia al resumen que recibe las notas
+ * @param origen Referencia constante al resumen que se mezcla
+ */
+void mezclarSketch(SketchKLL &destino, const SketchKLL &origen) {
+    if (origen.num == 0) return;
+    if (destino.num == 0 or origen.minimo < destino.minimo) destino.minimo = origen.minimo;
+    if (destino.num == 0 or origen.maximo > destino.maximo) destino.maximo = origen.maximo;
+    destino.num += origen.num;
+    if (destino.niveles.size() < origen.niveles.size()) {
+        destino.niveles.resize(origen.niveles.size());
+        ajustarCapacidades(destino);
+    }
+    for (size_t h = 0; h < origen.niveles.size(); h++) {
+        destino.niveles[h].insert(destino.niveles[h].end(), origen.niveles[h].begin(), origen.niveles[h].end());
+    }
+    destino.guardadas += origen.guardadas;
+    comprimirSketch(destino);
+}
+
+
+/**
+ * Calcula varios percentiles aproximados de las notas de un resumen KLL
+ * Ordena una sola vez las O(k) notas guardadas con su peso y, para cada
+ * fracción, busca la primera nota cuyo peso acumulado la alcanza
+ * @param sketch Referencia constante al resumen
+ * @param fracciones Fracciones de las notas que quedan por debajo, de 0
+ * a 1 (0.5 para la mediana, 0.9 para el percentil 90...)
+ * @return Las notas de los percentiles, en el orden de las fracciones;
+ * 0 si el resumen está vacío
+ */
+vector<float> getPercentiles(const SketchKLL &sketch, const vector<double> &fracciones) {
+    vector<float> percentiles(fracciones.size(), 0);
+    if (sketch.num == 0) return percentiles;
+    vector<pair<float, int64_t>> pesadas;
+    pesadas.reserve(sketch.guardadas);
+    for (size_t h = 0; h < sketch.niveles.size(); h++) {
+        for (const float nota: sketch.niveles[h]) pesadas.emplace_back(nota, int64_t{1} << h);
+    }
+    sort(pesadas.begin(), pesadas.end());
+    for (int64_t i = 1; i < static_cast<int64_t>(pesadas.size()); i++) pesadas[i].second += pesadas[i - 1].second;
+    for (size_t f = 0; f < fracciones.size(); f++) {
+        const double objetivo = fracciones[f] * static_cast<double>(pesadas.back().second);
+        const auto percentil = lower_bound(pesadas.begin(), pesadas.end(), objetivo,
+                                           [](const pair<float, int64_t> &pesada, const double valor) {
+                                               return static_cast<double>(pesada.second) < valor;
+                                           });
+        percentiles[f] = fracciones[f] <= 0 ? sketch.minimo
+                                            : percentil == pesadas.end() ? sketch.maximo : percentil->first;
+    }
+    return percentiles;
+}
+
+
+/**
+ * Calcula un percentil aproximado de las notas de un resumen KLL
+ * @param sketch Referencia constante al resumen
+ * @param fraccion Fracción de las notas que quedan por debajo, de 0 a 1
+ * @return La nota del percentil o 0 si el resumen está vacío
+ */
+float getPercentil(const SketchKLL &sketch, const double fraccion) {
+    return getPercentiles(sketch, {fraccion})[0];
+}
+
+
+/**
+ * Calcula los bytes que ocupan las notas guardadas en un resumen KLL y
+ * las capacidades de sus niveles
+ * @param sketch Referencia constante al resumen
+ * @return Bytes del resumen
+ */
+size_t getBytesSketch(const SketchKLL &sketch) {
+    size_t bytes = sizeof(SketchKLL) + sketch.capacidades.capacity() * sizeof(size_t);
+    for (const pmr::vector<float> &nivel: sketch.niveles) {
+        bytes += sizeof(pmr::vector<float>) + nivel.capacity() * sizeof(float);
+    }
+    return bytes;
+}
+
+
+/**
+ * Conjunto de alumnos de una lista como mapa de bits: el bit i de la
+ * palabra i / 64 está a 1 si el alumno de la posición i pertenece al conjunto
+ * Las operaciones entre conjuntos y las cuentas trabajan con palabras de
+ * 64 bits, de modo que cuestan n / 64 operaciones
+ */
+using ConjuntoAlumnos = pmr::vector<uint64_t>;
+
+// Umbrales enteros de nota con índice de mapa de bits: nota >= 1, ..., nota >= 10
+const int NUM_UMBRALES_NOTA = 10;
+
+
+/**
+ * Índice de mapas de bits de las notas de una lista
+ * El campo notaMinima[u - 1] es el conjunto de alumnos con nota >= u; los
+ * alumnos con nota en una franja [a, b) son los de notaMinima[a - 1] que
+ * no están en notaMinima[b - 1], así que no hace falta un mapa por franja
+ * Con 10 bits por alumno el índice ocupa mucho menos que los propios
+ * alumnos; las posiciones son densas (0..num - 1) y cada umbral suele
+ * incluir una fracción grande de la lista, así que comprimirlo por
+ * contenedores al estilo roaring no ahorraría memoria y haría más lentas
+ * las operaciones
+ */
+struct IndiceNotas {
+    pmr::vector<ConjuntoAlumnos> notaMinima; // Un conjunto por umbral, del recurso de memoria de la lista
+};
+
+
+/**
+ * Añade al índice de notas el alumno de la siguiente posición de la lista
+ * @param indice Referencia al índice
+ * @param posicion Posición del alumno en la lista; tiene que ser la
+ * siguiente a la del último alumno añadido
+ * @param nota Nota del alumno
+ */
+void actualizarIndiceNotas(IndiceNotas &indice, const int posicion, const float nota) {
+    const size_t palabra = static_cast<size_t>(posicion) / 64;
+    const uint64_t bit = uint64_t{1} << (posicion % 64);
+    for (int u = 1; u <= NUM_UMBRALES_NOTA; u++) {
+        ConjuntoAlumnos &conjunto = indice.notaMinima[u - 1];
+        if (conjunto.size() <= palabra) conjunto.resize(palabra + 1, 0);
+        if (nota >= static_cast<float>(u)) conjunto[palabra] |= bit;
+    }
+}
+
+
+/**
+ * Calcula los bytes de los mapas de bits de un índice de notas,
+ * reservados enteros según su capacidad
+ * @param indice Referencia constante al índice
+ * @return Bytes del índice fuera de la lista
+ */
+size_t getBytesIndiceNotas(const IndiceNotas &indice) {
+    size_t bytes = indice.notaMinima.capacity() * sizeof(ConjuntoAlumnos);
+    for (const ConjuntoAlumnos &conjunto: indice.notaMinima) bytes += conjunto.capacity() * sizeof(uint64_t);
+    return bytes;
+}
+
+
+/**
+ * Cuenta los alumnos de un conjunto
+ * @param conjunto Referencia constante al conjunto
+ * @return Número de bits a 1
+ */
+int64_t contarAlumnos(const ConjuntoAlumnos &conjunto) {
+    int64_t total = 0;
+    for (const uint64_t palabra: conjunto) total += popcount(palabra);
+    return total;
+}
+
+
+/**
+ * Calcula la intersección de dos conjuntos de alumnos de la misma lista
+ * @param a Referencia constante al primer conjunto
+ * @param b Referencia constante al segundo conjunto
+ * @return Alumnos que están en los dos conjuntos
+ */
+ConjuntoAlumnos intersecar(const ConjuntoAlumnos &a, const ConjuntoAlumnos &b) {
+    ConjuntoAlumnos resultado(min(a.size(), b.size()));
+    for (size_t i = 0; i < resultado.size(); i++) resultado[i] = a[i] & b[i];
+    return resultado;
+}
+
+
+/**
+ * Calcula la unión de dos conjuntos de alumnos de la misma lista
+ * @param a Referencia constante al primer conjunto
+ * @param b Referencia constante al segundo conjunto
+ * @return Alumnos que están en alguno de los dos conjuntos
+ */
+ConjuntoAlumnos unir(const ConjuntoAlumnos &a, const ConjuntoAlumnos &b) {
+    ConjuntoAlumnos resultado(max(a.size(), b.size()), 0);
+    for (size_t i = 0; i < a.size(); i++) resultado[i] = a[i];
+    for (size_t i = 0; i < b.size(); i++) resultado[i] |= b[i];
+    return resultado;
+}
+
+
+/**
+ * Calcula la diferencia de dos conjuntos de alumnos de la misma lista
+ * @param a Referencia constante al conjunto del que se quitan alumnos
+ * @param b Referencia constante al conjunto de alumnos que se quitan
+ * @return Alumnos de a que no están en b
+ */
+ConjuntoAlumnos restar(const ConjuntoAlumnos &a, const ConjuntoAlumnos &b) {
+    ConjuntoAlumnos resultado(a);
+    for (size_t i = 0; i < min(a.size(), b.size()); i++) resultado[i] &= ~b[i];
+    return resultado;
+}
+
+
+/**
+ * Obtiene las posiciones de los alumnos de un conjunto en orden creciente,
+ * saltando de bit a 1 en bit a 1
+ * @param conjunto Referencia constante al conjunto
+ * @return Posiciones de los alumnos del conjunto
+ */
+vector<int> getPosiciones(const ConjuntoAlumnos &conjunto) {
+    vector<int> posiciones;
+    posiciones.reserve(static_cast<size_t>(contarAlumnos(conjunto)));
+    for (size_t i = 0; i < conjunto.size(); i++) {
+        for (uint64_t palabra = conjunto[i]; palabra != 0; palabra &= palabra - 1) {
+            posiciones.push_back(static_cast<int>(i * 64 + countr_zero(palabra)));
+        }
+    }
+    return posiciones;
+}
+
+
+/**
+ * Entrada del índice ordenado de notas: nota del alumno y su posición en la lista
+ */
+struct EntradaNota {
+    float nota;
+    int posicion;
+};
+
+// Altas que se acumulan sin ordenar antes de pasarlas a un tramo ordenado del índice de notas
+const size_t MAX_PENDIENTES_INDICE = 512;
+
+
+/**
+ * Índice ordenado de las notas de una lista como conjunto de tramos ordenados
+ * Cada tramo del campo tramos tiene sus entradas ordenadas por nota y, a
+ * igual nota, por posición; cada tramo es más del doble de grande que el
+ * siguiente, así que hay O(log n) tramos. El campo pendientes tiene las
+ * últimas altas sin ordenar, menos de MAX_PENDIENTES_INDICE
+ * Al añadir un alumno, las pendientes llenas se ordenan como un tramo
+ * nuevo y los últimos tramos se mezclan mientras no cumplan los tamaños,
+ * como los bits de un contador binario: cada entrada se mezcla O(log n)
+ * veces en total. Las consultas buscan en cada tramo por bisección y
+ * recorren las pendientes, sin modificar el índice
+ */
+struct IndiceOrdenNotas {
+    pmr::vector<pmr::vector<EntradaNota>> tramos;
+    pmr::vector<EntradaNota> pendientes;
+};
+
+
+/**
+ * Compara dos entradas del índice de notas por nota y, a igual nota, por posición
+ * @param a Referencia constante a la primera entrada
+ * @param b Referencia constante a la segunda entrada
+ * @return Verdadero si a va antes que b
+ */
+inline bool menorEntrada(const EntradaNota &a, const EntradaNota &b) {
+    return a.nota < b.nota or (a.nota == b.nota and a.posicion < b.posicion);
+}
+
+
+/**
+ * Añade una entrada al índice ordenado de notas. Si se llenan las
+ * pendientes pasan a ser el último tramo, que se mezcla con el anterior
+ * mientras este no sea más del doble de grande
+ * @param indice Referencia al índice
+ * @param entrada Nota y posición del alumno añadido
+ */
+void insertarEntradaNota(IndiceOrdenNotas &indice, const EntradaNota entrada) {
+    indice.pendientes.push_back(entrada);
+    if (indice.pendientes.size() < MAX_PENDIENTES_INDICE) return;
+    sort(indice.pendientes.begin(), indice.pendientes.end(), menorEntrada);
+    indice.tramos.push_back(std::move(indice.pendientes));
+    indice.pendientes.clear();
+    indice.pendientes.reserve(MAX_PENDIENTES_INDICE);
+    while (indice.tramos.size() >= 2) {
+        const pmr::vector<EntradaNota> &anterior = indice.tramos[indice.tramos.size() - 2];
+        const pmr::vector<EntradaNota> &ultimo = indice.tramos.back();
+        if (anterior.size() > 2 * ultimo.size()) break;
+        pmr::vector<EntradaNota> mezcla(anterior.size() + ultimo.size(), indice.tramos.get_allocator());
+        merge(anterior.begin(), anterior.end(), ultimo.begin(), ultimo.end(), mezcla.begin(), menorEntrada);
+        indice.tramos.pop_back();
+        indice.tramos.back() = std::move(mezcla);
+    }
+}
+
+
+/**
+ * Calcula los bytes de los tramos y las entradas pendientes de un índice
+ * ordenado de notas, reservados enteros según su capacidad
+ * @param indice Referencia constante al índice
+ * @return Bytes del índice fuera de la lista
+ */
+size_t getBytesOrdenNotas(const IndiceOrdenNotas &indice) {
+    size_t bytes = indice.tramos.capacity() * sizeof(pmr::vector<EntradaNota>) +
+                   indice.pendientes.capacity() * sizeof(EntradaNota);
+    for (const pmr::vector<EntradaNota> &tramo: indice.tramos) bytes += tramo.capacity() * sizeof(EntradaNota);
+    return bytes;
+}
+
+
+/**
+ * Datos agregados de una lista de alumnos que se guardan en la propia lista
+ * para no recorrerla de nuevo mientras no cambie. El campo version es la
+ * versión de la lista a la que corresponden los datos (0 si no se han calculado)
+ */
+struct AgregadosLista {
+    uint64_t version;
+    double sumaNotas; // Suma de las notas de todos los alumnos
+    int numSuspensos; // Alumnos con nota inferior a 5
+    const Alumno *maxNota; // Primer alumno con la nota más alta o nulo si no hay alumnos
+};
+
+
+/**
+ * Filtros para listados de alumnos
+ */
+enum FiltroLista {
+    FILTRO_TODOS, // Todos los alumnos
+    FILTRO_APROBADOS, // Alumnos con nota igual o superior a 5
+    FILTRO_SUSPENSOS // Alumnos con nota inferior a 5
+};
+
+
+/**
+ * Posiciones de los alumnos de una lista en el orden de un listado,
+ * calculadas para la versión de la lista del campo version (0 si no se
+ * han calculado)
+ */
+struct PosicionesCacheadas {
+    uint64_t version;
+    pmr::vector<int> posiciones;
+};
+
+
+// Fracciones de los percentiles de las notas que muestra el menú: mediana, 90 y 99
+const double FRACCIONES_PERCENTILES[] = {0.5, 0.9, 0.99};
+const int NUM_PERCENTILES = 3;
+
+
+/**
+ * Percentiles aproximados de las notas de una lista, de
+ * FRACCIONES_PERCENTILES, calculados para la versión de la lista del
+ * campo version (0 si no se han calculado)
+ */
+struct PercentilesCacheados {
+    uint64_t version;
+    float notas[NUM_PERCENTILES];
+};
+
+
+/**
+ * Tipos de consultas que guarda la cache de una lista de alumnos
+ */
+enum ConsultaCacheada {
+    CONSULTA_AGREGADOS, // Nota media, alumno con máxima nota y cuentas de suspensos y aprobados
+    CONSULTA_POSICIONES, // Listados ordenados o filtrados
+    CONSULTA_PERCENTILES, // Percentiles aproximados del resumen de notas
+    NUM_CONSULTAS_CACHEADAS
+};
+
+
+/**
+ * Contadores de uso de la cache para un tipo de consulta
+ * Un acierto devuelve un resultado guardado, un fallo lo calcula de nuevo
+ * y un parche lo mantiene al día al añadir un alumno sin recalcularlo
+ */
+struct ContadoresCache {
+    uint64_t aciertos;
+    uint64_t fallos;
+    uint64_t parches;
+};
+
+
+/**
+ * Cache de resultados de consultas de una lista de alumnos
+ * Cada resultado guarda la versión de la lista para la que se calculó y
+ * solo se usa si coincide con la versión actual
+ * El campo posiciones tiene un listado por orden (0: el de la lista;
+ * 1 + criterio: ordenado por ese criterio) y filtro; el listado de la
+ * lista sin filtro no se guarda porque es la propia lista
+ */
+struct CacheConsultas {
+    AgregadosLista agregados;
+    PosicionesCacheadas posiciones[4][3];
+    PercentilesCacheados percentiles;
+    ContadoresCache contadores[NUM_CONSULTAS_CACHEADAS];
+};
+
+
+/**
+ * Crea una cache de consultas vacía cuyos listados salen de un recurso de
+ * memoria. Hay que construirla ya con el recurso: asignar después una
+ * cache a otra no cambia el recurso de sus listados
+ * @param recurso Recurso de memoria de los listados
+ * @return La cache vacía
+ */
+CacheConsultas crearCache(pmr::memory_resource *recurso) {
+    const auto vacias = [recurso] {
+        return PosicionesCacheadas{0, pmr::vector<int>(recurso)};
+    };
+    return CacheConsultas{
+        .agregados = {},
+        .posiciones = {
+            {vacias(), vacias(), vacias()}, {vacias(), vacias(), vacias()},
+            {vacias(), vacias(), vacias()}, {vacias(), vacias(), vacias()},
+        },
+        .percentiles = {},
+        .contadores = {},
+    };
+}
+
+
+/**
+ * Estructura para manejar una lista de alumnos
+ * El campo capacidad especifica el número máximo de alumnos que podrá
+ * manejar la lista
+ * El campo num reflejará la cantidad real de alumnos que hay en la lista
+ * El campo alumnos guarda los alumnos por valor, seguidos en memoria, y es
+ * su dueño: al destruirse la lista se destruyen con ella. Se reserva
+ * entero según la capacidad, así que añadir alumnos nunca lo recoloca y
+ * la dirección de cada alumno no cambia mientras exista la lista
+ * El campo notas repite las notas de los alumnos en una columna contigua
+ * para que los agregados la recorran sin pasar por los nombres
+ * Los campos bytesNombres, reservasNombres y picoBytes llevan la cuenta
+ * de la memoria que ocupan los nombres que no caben en su string
+ * El campo version empieza en 1 y aumenta con cada cambio de la lista; la
+ * cache de consultas lo usa para saber qué resultados siguen al día. La
+ * cache puede actualizarse al consultar una lista constante
+ * El campo filtroNombres es un filtro de Bloom con los nombres de los
+ * alumnos que descarta sin más la mayoría de búsquedas de nombres que no
+ * están; solo cuando el filtro no descarta un nombre se consulta el campo
+ * indiceNombres, un índice exacto de nombres que se crea la primera vez
+ * que hace falta
+ * El campo recurso es el recurso de memoria del que salen la propia
+ * estructura, los alumnos con sus nombres, el
+ * filtro y los índices: monotónico para cargas de una sola vez, con
+ * bloques por tamaño para procesos largos o sobre un buffer fijo
+ */
+struct ListaAlumnos {
+    int capacidad;
+    int num;
+    pmr::vector<Alumno> alumnos; // Alumnos por valor, con la memoria de la capacidad ya reservada
+    pmr::vector<float> notas; // Nota de cada alumno, seguidas para recorrerlas con instrucciones vectoriales
+    size_t bytesNombres; // Bytes de los nombres reservados fuera de su string
+    size_t reservasNombres; // Reservas de memoria hechas para esos nombres
+    size_t picoBytes; // Máximo de bytes vivos alcanzado por la lista
+    uint64_t version; // Versión del contenido de la lista
+    mutable CacheConsultas cache; // Resultados de consultas ya calculados
+    FiltroBloom *filtroNombres; // Nombres de los alumnos añadidos
+    mutable pmr::unordered_map<string_view, int> *indiceNombres; // Nombre -> primera posición, o nulo si no se ha creado
+    SketchKLL sketchNotas; // Resumen de las notas para percentiles aproximados
+    IndiceNotas indiceNotas; // Mapas de bits de los alumnos que superan cada nota entera
+    IndiceOrdenNotas ordenNotas; // Alumnos ordenados por nota
+    Diario *diario; // Diario donde se registran las altas o nulo si no hay
+    uint32_t idCurso; // Identificador del curso de la lista en el diario
+    pmr::memory_resource *recurso; // Recurso de donde salen la lista, sus alumnos y sus índices
+};
+
+
+/**
+ * Calcula los bytes que ocupa el nombre de un alumno fuera de la
+ * estructura: el buffer dinámico del string si el texto no cabe en el
+ * espacio interno del string (optimización de cadenas cortas)
+ * @param alumno Referencia constante a una estructura de tipo Alumno
+ * @return Bytes del nombre fuera del alumno, 0 si cabe dentro
+ */
+size_t getBytesNombre(const Alumno &alumno) {
+    return usaMemoriaDinamica(alumno.nombre) ? alumno.nombre.capacity() + 1 : 0;
+}
+
+
+/**
+ * Calcula los bytes que ocupan los listados guardados en una cache de
+ * consultas, reservados según su capacidad; la propia estructura va
+ * dentro de la lista
+ * @param cache Referencia constante a la cache
+ * @return Bytes de los listados
+ */
+size_t getBytesCache(const CacheConsultas &cache) {
+    size_t bytes = 0;
+    for (const auto &listados: cache.posiciones) {
+        for (const PosicionesCacheadas &entrada: listados) bytes += entrada.posiciones.capacity() * sizeof(int);
+    }
+    return bytes;
+}
+
+
+/**
+ * Calcula aproximadamente los bytes del índice exacto de nombres de una
+ * lista: la tabla de cubetas y un nodo por nombre con su hash guardado
+ * @param indice Puntero constante al índice, o nulo si no se ha creado
+ * @return Bytes del índice, 0 si no existe
+ */
+size_t getBytesIndiceNombres(const pmr::unordered_map<string_view, int> *indice) {
+    if (indice == nullptr) return 0;
+    const size_t bytesNodo = sizeof(void *) + sizeof(pair<const string_view, int>) + sizeof(size_t);
+    return sizeof(*indice) + indice->bucket_count() * sizeof(void *) + indice->size() * bytesNodo;
+}
+
+
+/**
+ * Bytes vivos de la lista: la estructura ListaAlumnos, los alumnos y la
+ * columna de notas (reservados enteros según su capacidad), los nombres,
+ * los listados de la cache de consultas, el filtro de nombres, el
+ * índice de nombres si se ha creado, los índices de notas y el resumen de notas
+ * @param lista Puntero a una estructura constante de tipo ListaAlumnos
+ * @return Bytes ocupados por la lista completa
+ */
+size_t getBytesLista(const ListaAlumnos *lista) {
+    if (lista == nullptr) return 0;
+    return sizeof(ListaAlumnos) + lista->capacidad * (sizeof(Alumno) + sizeof(float)) + lista->bytesNombres +
+           getBytesCache(lista->cache) + getBytesFiltroBloom(lista->filtroNombres) +
+           getBytesIndiceNombres(lista->indiceNombres) + getBytesIndiceNotas(lista->indiceNotas) +
+           getBytesOrdenNotas(lista->ordenNotas) + getBytesSketch(lista->sketchNotas);
+}
+
+
+/**
+ * Comprueba si un vector tiene memoria reservada
+ * @param vector Referencia constante al vector
+ * @return 1 si el vector tiene una reserva viva y 0 si no
+ */
+template<typename V>
+size_t getReservasVector(const V &vector) {
+    return vector.capacity() > 0 ? 1 : 0;
+}
+
+
+/**
+ * Cuenta las reservas de memoria dinámica vivas de una lista recorriendo
+ * las mismas estructuras que getBytesLista: la propia lista, las columnas
+ * de alumnos y notas, los nombres, los listados de la cache, el filtro y
+ * sus bloques, el índice de nombres (objeto, cubetas y un nodo por
+ * nombre), los niveles del resumen de notas y los vectores de los dos
+ * índices de notas
+ * @param lista Puntero a una estructura constante de tipo ListaAlumnos
+ * @return Número de reservas vivas
+ */
+size_t getReservasLista(const ListaAlumnos *lista) {
+    if (lista == nullptr) return 0;
+    size_t reservas = 1 + getReservasVector(lista->alumnos) + getReservasVector(lista->notas) + lista->reservasNombres;
+    for (const auto &listados: lista->cache.posiciones) {
+        for (const PosicionesCacheadas &entrada: listados) reservas += getReservasVector(entrada.posiciones);
+    }
+    if (lista->filtroNombres != nullptr) reservas += 2;
+    if (lista->indiceNombres != nullptr) {
+        // Con una sola cubeta, la tabla va dentro del propio objeto
+        reservas += 1 + (lista->indiceNombres->bucket_count() > 1 ? 1 : 0) + lista->indiceNombres->size();
+    }
+    const SketchKLL &sketch = lista->sketchNotas;
+    reservas += getReservasVector(sketch.niveles) + getReservasVector(sketch.capacidades);
+    for (const pmr::vector<float> &nivel: sketch.niveles) reservas += getReservasVector(nivel);
+    reservas += getReservasVector(lista->indiceNotas.notaMinima);
+    for (const ConjuntoAlumnos &conjunto: lista->indiceNotas.notaMinima) reservas += getReservasVector(conjunto);
+    const IndiceOrdenNotas &orden = lista->ordenNotas;
+    reservas += getReservasVector(orden.tramos) + getReservasVector(orden.pendientes);
+    for (const pmr::vector<EntradaNota> &tramo: orden.tramos) reservas += getReservasVector(tramo);
+    return reservas;
+}
+
+/**
+ * Pide el nombre de un curso mediante entrada por teclado
+ * Comprueba que el texto no esté vacío, de lo contrario
+ * vuelve a pedir al usuario la introducción del dato
+ * @return Un string con el nombre del curso
+ */
+string inputNombreCurso() {
+    string nombre;
+    do {
+        cout << "Introduce el nombre del curso:";
+        getline(cin, nombre);
+        if (nombre.empty()) {
+            cout << "El nombre no puede quedar vacio!!!\n";
+        }
+    } while (nombre.empty());
+    return nombre;
+}
+
+
+/**
+ * Pide al usuario la capacidad maxima de almacenar Alumnos en una lista
+ * Comprueba que el valor es un número positivo mayor que cero,
+ * si no es así, vuelve a preguntar al usuario
+ * @return Un valor positivo distinto de cero
+ */
+int inputCapacidad() {
+    MEDIR_OPERACION(OP_INPUT_CAPACIDAD);
+    int capacidad;
+    do {
+        cout << "Introduce capacidad maxima de la lista de alumnos:";
+        cin >> capacidad;
+        if (capacidad <= 0) {
+            cout << "La capacidad tiene que ser un valor positivo!\n";
+        }
+    } while (capacidad <= 0);
+    return capacidad;
+}
+
+
+/**
+ * A partir de valor entero proporcionado como argumento de llamada que indica
+ * el máximo número de alumnos que queremos alojar en la lista
+ * reserva memoria dinámicamente para crear la estructura ListaAlumnos
+ * e inicializa apropiadamente sus campos capacidad y num
+ * además de reservar la memoria para todos los alumnos de manera
+ * contigua en memoria
+ * Toda la memoria de la lista sale del recurso de memoria indicado, que
+ * tiene que seguir vivo hasta después de destruir la lista
+ * @param capacidad Número máximo de alumnos que queremos que tenga la lista
+ * @param recurso Recurso de memoria de la lista
+ * @return devuelve un puntero que apunta a la zona de memoria reservada para
+ * los datos de la estructura ListaAlumnos
+ */
+ListaAlumnos *crearLista(const int capacidad, pmr::memory_resource *recurso = pmr::get_default_resource()) {
+    pmr::polymorphic_allocator<> asignador(recurso);
+    // Los índices se construyen ya con el recurso: asignarlos después no lo cambiaría
+    ListaAlumnos *lista = asignador.new_object<ListaAlumnos>(ListaAlumnos{
+        .capacidad = capacidad,
+        .num = 0,
+        .alumnos = pmr::vector<Alumno>(recurso),
+        .notas = pmr::vector<float>(recurso),
+        .bytesNombres = 0,
+        .reservasNombres = 0,
+        .picoBytes = 0,
+        .version = 1,
+        .cache = crearCache(recurso),
+        .filtroNombres = crearFiltroBloom(min<int64_t>(capacidad, NOMBRES_INICIALES_FILTRO), fprFiltroNombres, recurso),
+        .indiceNombres = nullptr,
+        .sketchNotas = crearSketch(K_SKETCH_NOTAS, recurso),
+        .indiceNotas = {pmr::vector<ConjuntoAlumnos>(NUM_UMBRALES_NOTA, recurso)},
+        .ordenNotas = {pmr::vector<pmr::vector<EntradaNota>>(recurso), pmr::vector<EntradaNota>(recurso)},
+        .diario = nullptr,
+        .idCurso = 0,
+        .recurso = recurso,
+    });
+    lista->alumnos.reserve(capacidad);
+    lista->notas.reserve(capacidad);
+    lista->picoBytes = getBytesLista(lista);
+    return lista;
+}
+
+/**
+ * Libera toda la memoria reservada por la lista de alumnos
+ * Para ello, libera
+ * el filtro y el índice de nombres
+ * la memoria de los campos de la propia estructura ListaAlumnos, que
+ * destruyen con ella los alumnos guardados por valor y sus nombres
+ * @param lista Puntero a una estructura de tipo ListaAlumnos
+ */
+void destruirLista(ListaAlumnos *lista) {
+    if (lista == nullptr) return;
+    pmr::polymorphic_allocator<> asignador(lista->recurso);
+    destruirFiltroBloom(lista->filtroNombres);
+    if (lista->indiceNombres != nullptr) asignador.delete_object(lista->indiceNombres);
+    asignador.delete_object(lista); // Libera la memoria reservada por la estructura ListaAlumnos
+}
+
+
+/**
+ * Método que comprueba si una lista proporcionada como argumento de llamada
+ * tiene o no alumnos insertados en ella
+ * @param lista Puntero a una estructura de tipo ListaAlumnos
+ * @return valor bool verdadero si la lista no tiene ningún alumno añadido o
+ * falso si la lista ya tiene al menos un alumno
+ */
+inline bool estaVacia(const ListaAlumnos *lista) {
+    //Aquí aprovechamos que el operador or es por cortocircuito,
+    //si lo primero es cierto no se evalúa lo segundo
+    //Ya que si no hay lista, no hay numero que comprobar si es cero
+    return lista == nullptr or lista->num == 0;
+}
+
+
+/**
+ * Método que comprueba si una lista proporcionada como argumento de llamada
+ * tiene el máximo de alumnos que puede manejar ya añadidos
+ * @param lista Puntero a una estructura de tipo ListaAlumnos
+ * @return Valor booleano verdadero si la lista ha llegado al máximo de su capacidad o
+ * falso si la lista todavía permite añadir algún alumno más
+ */
+inline bool estaLlena(const ListaAlumnos *lista) {
+    // Aprovechamos que el operador and cortocircuita y no
+    // sigue evaluando el segundo operando (derecha) si el primero es falso
+    return lista != nullptr and lista->num == lista->capacidad;
+}
+
+
+/**
+ * Actualiza la versión de una lista y su cache de consultas al añadir un
+ * alumno, que ya debe estar al final de la lista
+ * Los resultados al día se parchean cuando es barato: los agregados se
+ * actualizan con la nota del alumno, los listados en el orden de la lista
+ * se amplían con su posición y los listados que el filtro deja fuera al
+ * alumno no cambian. Los listados ordenados que lo incluyen quedan
+ * obsoletos y se recalculan la próxima vez que se pidan
+ * @param lista Puntero a una estructura de tipo ListaAlumnos
+ * @param alumno Puntero a la estructura del alumno añadido
+ */
+void actualizarCacheAlta(ListaAlumnos *lista, const Alumno *alumno) {
+    const uint64_t anterior = lista->version++;
+    CacheConsultas &cache = lista->cache;
+    AgregadosLista &agregados = cache.agregados;
+    if (agregados.version == anterior) {
+        agregados.sumaNotas += alumno->nota;
+        if (alumno->nota < 5) agregados.numSuspensos++;
+        if (agregados.maxNota == nullptr or alumno->nota > agregados.maxNota->nota) agregados.maxNota = alumno;
+        agregados.version = lista->version;
+        cache.contadores[CONSULTA_AGREGADOS].parches++;
+    }
+    for (int orden = 0; orden < 4; orden++) {
+        for (int filtro = 0; filtro < 3; filtro++) {
+            PosicionesCacheadas &entrada = cache.posiciones[orden][filtro];
+            if (entrada.version != anterior) continue;
+            const bool incluido = filtro == FILTRO_TODOS or (alumno->nota >= 5) == (filtro == FILTRO_APROBADOS);
+            if (incluido and orden != 0) continue; // Obsoleto
+            if (incluido) entrada.posiciones.push_back(lista->num - 1);
+            entrada.version = lista->version;
+            cache.contadores[CONSULTA_POSICIONES].parches++;
+        }
+    }
+}
+
+
+/**
+ * Vuelve a crear el filtro de nombres de una lista para el doble de los
+ * alumnos que tiene, sin pasar de su capacidad, cuando ya se han insertado
+ * más nombres de los previstos. Así el filtro crece con los alumnos
+ * añadidos y no ocupa desde el principio lo que pide la capacidad; como
+ * cada vez dobla su tamaño, cada nombre se vuelve a insertar O(1) veces de media
+ * Las estadísticas de búsquedas del filtro anterior se conservan
+ * @param lista Puntero a una estructura de tipo ListaAlumnos
+ */
+void ampliarFiltroNombres(ListaAlumnos *lista) {
+    FiltroBloom *anterior = lista->filtroNombres;
+    FiltroBloom *filtro = crearFiltroBloom(min<int64_t>(2LL * lista->num, lista->capacidad),
+                                           anterior->fprObjetivo, lista->recurso);
+    for (int i = 0; i < lista->num; i++) insertarFiltroBloom(filtro, calcularHashNombre(lista->alumnos[i].nombre));
+    filtro->consultas = anterior->consultas;
+    filtro->descartes = anterior->descartes;
+    filtro->falsosPositivos = anterior->falsosPositivos;
+    destruirFiltroBloom(anterior);
+    lista->filtroNombres = filtro;
+}
+
+
+/**
+ * Añade un nuevo alumno a la lista después del último alumno de la lista
+ * moviéndolo a su hueco: el nombre solo se copia si estaba reservado en
+ * otro recurso de memoria
+ * Si la lista tiene diario, el alta se registra en él antes de añadirlo
+ * @param lista Puntero a una estructura de tipo ListaAlumnos
+ * @param alumno Alumno a añadir, que pasa a ser de la lista
+ * @return Verdadero si se ha podido añadir el alumno o falso si la lista
+ * estaba llena o el diario no admite más registros
+ */
+bool addAlumno(ListaAlumnos *lista, Alumno &&alumno) {
+    MEDIR_OPERACION(OP_ADD_ALUMNO);
+    if (estaLlena(lista)) return false; // Si la lista está llena no hay nada que insertar
+    if (lista->diario != nullptr and not registrarAltaAlumno(lista->diario, lista->idCurso, &alumno)) return false;
+    // Cabe en la memoria reservada, así que los alumnos anteriores no se mueven
+    const Alumno *nuevo = &lista->alumnos.emplace_back(
+            Alumno{pmr::string(std::move(alumno.nombre), lista->recurso), alumno.nota});
+    lista->num++;
+    lista->notas.push_back(nuevo->nota);
+    lista->bytesNombres += getBytesNombre(*nuevo);
+    if (usaMemoriaDinamica(nuevo->nombre)) lista->reservasNombres++;
+    actualizarCacheAlta(lista, nuevo);
+    insertarFiltroBloom(lista->filtroNombres, calcularHashNombre(nuevo->nombre));
+    if (lista->filtroNombres->insertados > lista->filtroNombres->previstos) ampliarFiltroNombres(lista);
+    if (lista->indiceNombres != nullptr) lista->indiceNombres->emplace(nuevo->nombre, lista->num - 1);
+    lista->picoBytes = max(lista->picoBytes, getBytesLista(lista));
+    actualizarSketch(lista->sketchNotas, nuevo->nota);
+    actualizarIndiceNotas(lista->indiceNotas, lista->num - 1, nuevo->nota);
+    insertarEntradaNota(lista->ordenNotas, {nuevo->nota, lista->num - 1});
+    return true;
+}
+
+
+/**
+ * Añade un nuevo alumno a la lista construyéndolo en su hueco a partir
+ * de su nombre y su nota
+ * @param lista Puntero a una estructura de tipo ListaAlumnos
+ * @param nombre Nombre del alumno
+ * @param nota Nota del alumno
+ * @return Verdadero si se ha podido añadir el alumno o falso si la lista
+ * estaba llena o el diario no admite más registros
+ */
+bool addAlumno(ListaAlumnos *lista, const string_view nombre, const float nota) {
+    if (estaLlena(lista)) return false; // Sin hueco no se llega a copiar el nombre
+    return addAlumno(lista, crearAlumno(lista->recurso, nombre, nota));
+}
+
+
+/**
+ * Devuelve los agregados de una lista de alumnos guardados en su cache
+ * o, si no están al día, los recalcula recorriéndola una sola vez
+ * Las listas grandes se recorren en paralelo por bloques en el pool de
+ * hilos y los agregados de los bloques se combinan en orden, de modo que
+ * maxNota sigue siendo el primer alumno con la nota más alta
+ * @param lista Puntero a una estructura constante de tipo ListaAlumnos
+ * @return Referencia constante a los agregados de la lista
+ */
+const AgregadosLista &actualizarAgregados(const ListaAlumnos *lista) {
+    AgregadosLista &agregados = lista->cache.agregados;
+    ContadoresCache &contadores = lista->cache.contadores[CONSULTA_AGREGADOS];
+    if (agregados.version == lista->version) {
+        contadores.aciertos++;
+        return agregados;
+    }
+    contadores.fallos++;
+    const int64_t TAM_BLOQUE = 1 << 16;
+    const int64_t numBloques = (lista->num + TAM_BLOQUE - 1) / TAM_BLOQUE;
+    vector<AgregadosLista> parciales(numBloques);
+    paraCada(0, numBloques, 1, [lista, &parciales, TAM_BLOQUE](const int64_t desde, const int64_t hasta) {
+        for (int64_t b = desde; b < hasta; b++) {
+            AgregadosLista &parcial = parciales[b];
+            const int64_t inicio = b * TAM_BLOQUE;
+            const int64_t n = min<int64_t>(lista->num, inicio + TAM_BLOQUE) - inicio;
+            const float *notas = lista->notas.data() + inicio;
+            parcial.sumaNotas = kernelsNotas->sumar(notas, n);
+            parcial.numSuspensos = static_cast<int>(kernelsNotas->contarMenores(notas, n, 5));
+            parcial.maxNota = &lista->alumnos[inicio + kernelsNotas->posicionMaxima(notas, n)];
+        }
+    });
+    agregados = AgregadosLista{};
+    for (const AgregadosLista &parcial: parciales) {
+        agregados.sumaNotas += parcial.sumaNotas;
+        agregados.numSuspensos += parcial.numSuspensos;
+        if (agregados.maxNota == nullptr or parcial.maxNota->nota > agregados.maxNota->nota) {
+            agregados.maxNota = parcial.maxNota;
+        }
+    }
+    agregados.version = lista->version;
+    return agregados;
+}
+
+
+/**
+ * Devuelve los percentiles de FRACCIONES_PERCENTILES de las notas de una
+ * lista guardados en su cache o, si no están al día, los calcula a partir
+ * de su resumen de notas
+ * @param lista Puntero a una estructura constante de tipo ListaAlumnos
+ * @return Referencia constante a los percentiles de la lista
+ */
+const PercentilesCacheados &actualizarPercentiles(const ListaAlumnos *lista) {
+    PercentilesCacheados &percentiles = lista->cache.percentiles;
+    ContadoresCache &contadores = lista->cache.contadores[CONSULTA_PERCENTILES];
+    if (percentiles.version == lista->version) {
+        contadores.aciertos++;
+        return percentiles;
+    }
+    contadores.fallos++;
+    const vector<float> notas = getPercentiles(
+            lista->sketchNotas, vector<double>(begin(FRACCIONES_PERCENTILES), end(FRACCIONES_PERCENTILES)));
+    copy(notas.begin(), notas.end(), percentiles.notas);
+    percentiles.version = lista->version;
+    return percentiles;
+}
+
+
+/**
+ * Busca un alumno por su nombre
+ * Primero consulta el filtro de Bloom de la lista, que descarta casi todos
+ * los nombres que no están leyendo una sola línea de caché; solo si el
+ * filtro no lo descarta se busca en el índice exacto de nombres, que se
+ * crea la primera vez a partir de los alumnos de la lista
+ * @param lista Puntero a una estructura constante de tipo ListaAlumnos
+ * @param nombre Nombre a buscar
+ * @return Posición del primer alumno con ese nombre o -1 si no hay ninguno
+ */
+int buscarAlumno(const ListaAlumnos *lista, const string_view nombre) {
+    FiltroBloom *filtro = lista->filtroNombres;
+    filtro->consultas++;
+    if (not puedeContener(filtro, calcularHashNombre(nombre))) {
+        filtro->descartes++;
+        return -1;
+    }
+    if (lista->indiceNombres == nullptr) {
+        lista->indiceNombres = pmr::polymorphic_allocator<>(lista->recurso).new_object<pmr::unordered_map<string_view, int>>();
+        lista->indiceNombres->reserve(lista->num);
+        for (int i = 0; i < lista->num; i++) lista->indiceNombres->emplace(lista->alumnos[i].nombre, i);
+    }
+    const auto encontrado = lista->indiceNombres->find(nombre);
+    if (encontrado == lista->indiceNombres->end()) {
+        filtro->falsosPositivos++;
+        return -1;
+    }
+    return encontrado->second;
+}
+
+
+/**
+ * Obtiene el conjunto de alumnos de una lista con nota en la franja
+ * [desde, hasta) a partir del índice de notas, sin mirar los alumnos
+ * @param lista Puntero a una estructura constante de tipo ListaAlumnos
+ * @param desde Nota mínima, entera de 0 a 10
+ * @param hasta Nota a partir de la cual ya no se incluye, entera de 1 a
+ * 10 u 11 para no poner límite superior
+ * @return Conjunto de alumnos de la franja
+ */
+ConjuntoAlumnos getAlumnosEntreNotas(const ListaAlumnos *lista, const int desde, const int hasta) {
+    const IndiceNotas &indice = lista->indiceNotas;
+    ConjuntoAlumnos conjunto;
+    if (desde > 0) {
+        conjunto = indice.notaMinima[desde - 1];
+    } else {
+        conjunto.assign((static_cast<size_t>(lista->num) + 63) / 64, ~uint64_t{0});
+        if (lista->num % 64 != 0) conjunto.back() = (uint64_t{1} << (lista->num % 64)) - 1;
+    }
+    if (hasta <= NUM_UMBRALES_NOTA) conjunto = restar(conjunto, indice.notaMinima[hasta - 1]);
+    return conjunto;
+}
+
+
+/**
+ * Cuenta los alumnos de una lista con nota en la franja [desde, hasta)
+ * contando bits del índice de notas palabra a palabra, sin crear el conjunto
+ * @param lista Puntero a una estructura constante de tipo ListaAlumnos
+ * @param desde Nota mínima, entera de 0 a 10
+ * @param hasta Nota a partir de la cual ya no se incluye, entera de 1 a
+ * 10 u 11 para no poner límite superior
+ * @return Número de alumnos de la franja
+ */
+int64_t contarAlumnosEntreNotas(const ListaAlumnos *lista, const int desde, const int hasta) {
+    const IndiceNotas &indice = lista->indiceNotas;
+    if (hasta > NUM_UMBRALES_NOTA) return desde > 0 ? contarAlumnos(indice.notaMinima[desde - 1]) : lista->num;
+    if (desde == 0) return lista->num - contarAlumnos(indice.notaMinima[hasta - 1]);
+    const ConjuntoAlumnos &a = indice.notaMinima[desde - 1], &b = indice.notaMinima[hasta - 1];
+    int64_t total = 0;
+    for (size_t i = 0; i < a.size(); i++) total += popcount(a[i] & ~b[i]);
+    return total;
+}
+
+
+/**
+ * Calcula la nota media de los alumnos de una lista de alumnos proporcionada
+ * en un parámetro de entrada de tipo puntero a ListaAlumnos
+ * La suma de las notas sale de los agregados de la cache de la lista
+ * @param lista Puntero a una estructura de tipo ListaAlumnos
+ * @return Un float con el valor calculado de la nota media de los alumnos
+ */
+float getNotaMedia(const ListaAlumnos *lista) {
+    MEDIR_OPERACION(OP_NOTA_MEDIA);
+    if (estaVacia(lista)) return 0;
+    const double suma = actualizarAgregados(lista).sumaNotas; // Suma de las notas de todos los alumnos
+    return static_cast<float>(suma / lista->num); //suma dividida por total alumnos
+}
+
+
+/**
+ * Obtiene el alumno con mayor nota de todos a partir de los agregados de
+ * la lista: si no están al día se recalculan con el recorrido vectorial
+ * de la columna de notas (kernelsNotas->posicionMaxima) y cada alta los
+ * mantiene después sin recorrer la lista
+ * Debe comprobar si la lista está vacía y en ese caso devolver un puntero nulo
+ * Si la lista no está vacía debe devolver un puntero de tipo Alumno con
+ * la dirección de memoria donde se ubican los datos del alumno
+ * @param lista Puntero a una estructura de tipo ListaAlumnos
+ * @return Un puntero a la estructura de tipo Alumno que en la lista tiene mayor nota
+ */
+const Alumno *getAlumnoMaxNota(const ListaAlumnos *lista) {
+    MEDIR_OPERACION(OP_ALUMNO_MAX_NOTA);
+    if (estaVacia(lista)) return nullptr;
+    return actualizarAgregados(lista).maxNota;
+}
+
+
+/**
+ * Busca en un tramo del índice de notas las entradas con nota entre dos
+ * valores, ambos incluidos, con dos bisecciones
+ * @param tramo Referencia constante al tramo ordenado
+ * @param minima Nota mínima
+ * @param maxima Nota máxima
+ * @return Punteros a la primera entrada del intervalo y a la siguiente a la última
+ */
+pair<const EntradaNota *, const EntradaNota *> buscarEntreNotas(const pmr::vector<EntradaNota> &tramo,
+                                                                const float minima, const float maxima) {
+    const auto desde = lower_bound(tramo.begin(), tramo.end(), EntradaNota{minima, -1}, menorEntrada);
+    const auto hasta = upper_bound(desde, tramo.end(), EntradaNota{maxima, INT_MAX}, menorEntrada);
+    return {to_address(desde), to_address(hasta)};
+}
+
+
+/**
+ * Cuenta los alumnos de una lista con nota entre dos valores, ambos
+ * incluidos, con dos bisecciones en cada tramo del índice ordenado de notas
+ * @param lista Puntero a una estructura constante de tipo ListaAlumnos
+ * @param minima Nota mínima
+ * @param maxima Nota máxima
+ * @return Número de alumnos con nota en [minima, maxima]
+ */
+int contarEntreNotas(const ListaAlumnos *lista, const float minima, const float maxima) {
+    MEDIR_OPERACION(OP_CONTAR_ENTRE_NOTAS);
+    if (estaVacia(lista) or minima > maxima) return 0;
+    const IndiceOrdenNotas &indice = lista->ordenNotas;
+    int total = 0;
+    for (const pmr::vector<EntradaNota> &tramo: indice.tramos) {
+        const auto [desde, hasta] = buscarEntreNotas(tramo, minima, maxima);
+        total += static_cast<int>(hasta - desde);
+    }
+    for (const EntradaNota &entrada: indice.pendientes) {
+        if (entrada.nota >= minima and entrada.nota <= maxima) total++;
+    }
+    return total;
+}
+
+
+/**
+ * Obtiene los primeros alumnos de una lista con nota entre dos valores,
+ * ambos incluidos, ordenados por nota y, a igual nota, por posición en la
+ * lista. Mezcla sobre la marcha los intervalos de cada tramo del índice y
+ * las pendientes que entran en él, y para al llegar al límite, de modo
+ * que el coste es O(log² n + k log n) para k alumnos devueltos
+ * @param lista Puntero a una estructura constante de tipo ListaAlumnos
+ * @param minima Nota mínima
+ * @param maxima Nota máxima
+ * @param limite Número máximo de alumnos a devolver
+ * @return Posiciones de los alumnos con nota en [minima, maxima], como mucho limite
+ */
+vector<int> listarEntreNotas(const ListaAlumnos *lista, const float minima, const float maxima, const int limite) {
+    MEDIR_OPERACION(OP_LISTAR_ENTRE_NOTAS);
+    vector<int> posiciones;
+    if (estaVacia(lista) or minima > maxima or limite <= 0) return posiciones;
+    const IndiceOrdenNotas &indice = lista->ordenNotas;
+    vector<EntradaNota> pendientes;
+    for (const EntradaNota &entrada: indice.pendientes) {
+        if (entrada.nota >= minima and entrada.nota <= maxima) pendientes.push_back(entrada);
+    }
+    sort(pendientes.begin(), pendientes.end(), menorEntrada);
+    vector<pair<const EntradaNota *, const EntradaNota *>> intervalos; // Lo que queda por recorrer de cada tramo
+    for (const pmr::vector<EntradaNota> &tramo: indice.tramos) {
+        const auto intervalo = buscarEntreNotas(tramo, minima, maxima);
+        if (intervalo.first != intervalo.second) intervalos.push_back(intervalo);
+    }
+    if (not pendientes.empty()) intervalos.emplace_back(pendientes.data(), pendientes.data() + pendientes.size());
+    while (static_cast<int>(posiciones.size()) < limite and not intervalos.empty()) {
+        size_t menor = 0;
+        for (size_t t = 1; t < intervalos.size(); t++) {
+            if (menorEntrada(*intervalos[t].first, *intervalos[menor].first)) menor = t;
+        }
+        posiciones.push_back(intervalos[menor].first->posicion);
+        if (++intervalos[menor].first == intervalos[menor].second) {
+            intervalos[menor] = intervalos.back();
+            intervalos.pop_back();
+        }
+    }
+    return posiciones;
+}
+
+
+/**
+ * Calcula el puesto de un alumno en la clasificación por nota de su
+ * lista: 1 más el número de alumnos con nota estrictamente mayor, de
+ * modo que los alumnos empatados comparten puesto
+ * @param lista Puntero a una estructura constante de tipo ListaAlumnos
+ * @param posicion Posición del alumno en la lista
+ * @return Puesto del alumno, desde 1
+ */
+int getPuestoAlumno(const ListaAlumnos *lista, const int posicion) {
+    MEDIR_OPERACION(OP_PUESTO_ALUMNO);
+    const float nota = lista->alumnos[posicion].nota;
+    const IndiceOrdenNotas &indice = lista->ordenNotas;
+    int puesto = 1;
+    for (const pmr::vector<EntradaNota> &tramo: indice.tramos) {
+        const auto mayores = upper_bound(tramo.begin(), tramo.end(), EntradaNota{nota, INT_MAX}, menorEntrada);
+        puesto += static_cast<int>(tramo.end() - mayores);
+    }
+    for (const EntradaNota &entrada: indice.pendientes) {
+        if (entrada.nota > nota) puesto++;
+    }
+    return puesto;
+}
+
+
+// Alumnos que se recorren de una vez al buscar el primer suspenso
+const int64_t TAM_TRAMO_SUSPENSOS = 4096;
+
+
+/**
+ * Si la lista esta vacía, no existe ningún alumno en ella que este suspendido,
+ * por tanto, el método devuelve false.
+ * Si la lista contiene alumnos y los agregados de la cache están al día,
+ * se consulta su número de suspensos; si no, se recorre la columna de
+ * notas por tramos solo hasta encontrar el primero con un suspenso, sin
+ * calcular los agregados
+ * @param lista Puntero a una estructura de tipo ListaAlumnos
+ * @return Un bool con valor true si en la lista al menos un alumno tiene una
+ * nota inferior a 5 y falso en caso contrario o si la lista esta vacía
+ */
+bool existeAlumnoSuspenso(const ListaAlumnos *lista) {
+    MEDIR_OPERACION(OP_EXISTE_SUSPENSO);
+    if (estaVacia(lista)) return false;
+    const AgregadosLista &agregados = lista->cache.agregados;
+    ContadoresCache &contadores = lista->cache.contadores[CONSULTA_AGREGADOS];
+    if (agregados.version == lista->version) {
+        contadores.aciertos++;
+        return agregados.numSuspensos > 0;
+    }
+    contadores.fallos++;
+    const float *notas = lista->notas.data();
+    for (int64_t i = 0; i < lista->num; i += TAM_TRAMO_SUSPENSOS) {
+        if (kernelsNotas->contarMenores(notas + i, min(TAM_TRAMO_SUSPENSOS, lista->num - i), 5) > 0) return true;
+    }
+    return false;
+}
+
+
+/**
+ * Cuenta los alumnos de una lista que pasan un filtro, usando los
+ * agregados de la cache
+ * @param lista Puntero a una estructura constante de tipo ListaAlumnos
+ * @param filtro Alumnos que se cuentan
+ * @return Número de alumnos que pasan el filtro
+ */
+int contarAlumnos(const ListaAlumnos *lista, const FiltroLista filtro) {
+    if (estaVacia(lista)) return 0;
+    if (filtro == FILTRO_TODOS) return lista->num;
+    const int suspensos = actualizarAgregados(lista).numSuspensos;
+    return filtro == FILTRO_SUSPENSOS ? suspensos : lista->num - suspensos;
+}
+
+
+/**
+ * Resumen del uso de memoria de una lista de alumnos
+ */
+struct EstadisticasMemoria {
+    size_t bytesVivos; // Bytes ocupados ahora mismo por toda la lista
+    size_t reservas; // Número de reservas de memoria dinámica vivas
+    size_t picoBytes; // Máximo de bytes vivos alcanzado
+    double bytesPorAlumno; // Coste medio de cada alumno: estructura y nombre
+    size_t bytesDesperdiciados; // Alumnos y notas reservados por la capacidad y sin usar
+};
+
+
+/**
+ * Obtiene las estadísticas de uso de memoria de una lista de alumnos
+ * @param lista Puntero a una estructura constante de tipo ListaAlumnos
+ * @return Estructura EstadisticasMemoria con los datos calculados,
+ * todo a cero si no hay lista
+ */
+EstadisticasMemoria getEstadisticasMemoria(const ListaAlumnos *lista) {
+    EstadisticasMemoria estadisticas{};
+    if (lista == nullptr) return estadisticas;
+    estadisticas.bytesVivos = getBytesLista(lista);
+    estadisticas.reservas = getReservasLista(lista);
+    // La cache crece al consultar, no solo al añadir alumnos
+    estadisticas.picoBytes = max(lista->picoBytes, estadisticas.bytesVivos);
+    if (lista->num > 0) {
+        estadisticas.bytesPorAlumno =
+                static_cast<double>(lista->bytesNombres + lista->num * sizeof(Alumno)) / lista->num;
+    }
+    estadisticas.bytesDesperdiciados = (lista->alumnos.capacity() - lista->alumnos.size()) * sizeof(Alumno) +
+                                       (lista->notas.capacity() - lista->notas.size()) * sizeof(float);
+    return estadisticas;
+}
+
+
+/**
+ * Recursos de memoria que puede usar la lista de alumnos de un curso
+ */
+enum TipoRecurso : uint8_t {
+    RECURSO_GENERAL, // El recurso por defecto del programa (new/delete)
+    RECURSO_BLOQUES, // Bloques por tamaño, para cursos que cambian durante mucho tiempo
+    RECURSO_MONOTONICO, // Solo crece hasta eliminar el curso, para cargas de una sola vez
+    RECURSO_BUFFER_FIJO, // Monotónico sobre un buffer reservado al crear el curso
+    NUM_TIPOS_RECURSO
+};
+
+const char *nombresTiposRecurso[NUM_TIPOS_RECURSO] = {"general", "bloques", "monotonico", "buffer"};
+
+// Bytes del buffer fijo por alumno de capacidad y máximo del buffer. El
+// buffer se reserva entero al crear el curso: un curso de 100000 alumnos
+// reserva 25,6 MB y desde 4194304 alumnos se reserva el máximo, 1 GiB. Si
+// se queda corto, el recurso sigue pidiendo memoria al recurso general
+const size_t BYTES_BUFFER_POR_ALUMNO = 256;
+const size_t MAX_BUFFER_CURSO = size_t{1} << 30;
+
+
+/**
+ * Obtiene el tipo de recurso de memoria que corresponde a un nombre
+ * @param texto Nombre: general, bloques, monotonico o buffer
+ * @param tipo Salida con el tipo de recurso
+ * @return Verdadero si el nombre es un tipo de recurso conocido
+ */
+bool interpretarTipoRecurso(const string_view texto, TipoRecurso &tipo) {
+    for (int t = 0; t < NUM_TIPOS_RECURSO; t++) {
+        if (texto == nombresTiposRecurso[t]) {
+            tipo = static_cast<TipoRecurso>(t);
+            return true;
+        }
+    }
+    return false;
+}
+
+
+/**
+ * Estructura Curso que asocia un nombre a una lista de alumnos
+ * El campo id identifica al curso en el diario y no se reutiliza
+ * El campo recurso es el recurso de memoria propio de la lista, del tipo
+ * del campo tipoRecurso, o nulo si la lista usa el recurso general; el
+ * campo buffer es la memoria del recurso de buffer fijo, de bytesBuffer
+ * bytes reservados al recurso general, o nulo
+ */
+struct Curso {
+    uint32_t id;
+    string nombre;
+    ListaAlumnos *lista;
+    TipoRecurso tipoRecurso;
+    pmr::memory_resource *recurso;
+    byte *buffer;
+    size_t bytesBuffer;
+};
+
+
+/**
+ * Crea un curso con su lista de alumnos vacía, que sale de un recurso de
+ * memoria propio del curso según el tipo indicado
+ * @param id Identificador del curso
+ * @param nombre Nombre del curso
+ * @param capacidad Número máximo de alumnos del curso
+ * @param tipoRecurso Tipo de recurso de memoria de la lista
+ * @return Puntero al curso creado
+ */
+Curso *crearCurso(const uint32_t id, const string &nombre, const int capacidad, const TipoRecurso tipoRecurso) {
+    Curso *curso = new Curso{id, nombre, nullptr, tipoRecurso, nullptr, nullptr, 0};
+    if (tipoRecurso == RECURSO_BLOQUES) {
+        curso->recurso = new pmr::unsynchronized_pool_resource;
+    } else if (tipoRecurso == RECURSO_MONOTONICO) {
+        curso->recurso = new pmr::monotonic_buffer_resource;
+    } else if (tipoRecurso == RECURSO_BUFFER_FIJO) {
+        // El buffer y lo que no quepa en él salen del recurso general
+        pmr::memory_resource *general = pmr::get_default_resource();
+        curso->bytesBuffer = min(static_cast<size_t>(capacidad) * BYTES_BUFFER_POR_ALUMNO, MAX_BUFFER_CURSO);
+        curso->buffer = static_cast<byte *>(general->allocate(curso->bytesBuffer));
+        curso->recurso = new pmr::monotonic_buffer_resource(curso->buffer, curso->bytesBuffer, general);
+    }
+    curso->lista = curso->recurso == nullptr ? crearLista(capacidad) : crearLista(capacidad, curso->recurso);
+    return curso;
+}
+
+
+/**
+ * Libera la lista de alumnos de un curso, su recurso de memoria y el
+ * propio curso. La lista se destruye antes que el recurso del que sale
+ * @param curso Puntero a una estructura de tipo Curso
+ */
+void destruirCurso(Curso *curso) {
+    destruirLista(curso->lista);
+    delete curso->recurso;
+    if (curso->buffer != nullptr) pmr::get_default_resource()->deallocate(curso->buffer, curso->bytesBuffer);
+    delete curso;
+}
+
+
+/**
+ * Estructura para manejar un catálogo de cursos
+ * El campo cursos apunta a los cursos dados de alta, en orden de creación
+ * El campo seleccionado es la posición del curso sobre el que trabaja el
+ * menú de la aplicación o -1 si el catálogo está vacío
+ * Si el campo diario no es nulo, las altas y bajas de cursos y las altas
+ * de alumnos de todos los cursos se registran en él
+ * El campo sketchGlobal guarda los resúmenes de notas de los cursos ya
+ * mezclados; versionesSketch tiene el identificador de cada curso mezclado
+ * y la versión que tenía su lista, para mezclarlos de nuevo solo si cambian
+ */
+struct CatalogoCursos {
+    vector<Curso *> cursos;
+    int seleccionado;
+    uint32_t siguienteId; // Identificador del próximo curso que se cree
+    Diario *diario;
+    mutable SketchKLL sketchGlobal;
+    mutable vector<pair<uint32_t, uint64_t>> versionesSketch;
+};
+
+
+/**
+ * Reserva memoria dinámicamente para un catálogo de cursos vacío
+ * @return Puntero al catálogo creado
+ */
+CatalogoCursos *crearCatalogo() {
+    CatalogoCursos *catalogo = new CatalogoCursos;
+    catalogo->seleccionado = -1;
+    catalogo->siguienteId = 1;
+    catalogo->diario = nullptr;
+    iniciarSketch(catalogo->sketchGlobal, K_SKETCH_NOTAS);
+    return catalogo;
+}
+
+
+/**
+ * Elimina todos los cursos del catálogo liberando sus listas de alumnos,
+ * sin registrar nada en el diario, y lo deja como recién creado
+ * @param catalogo Puntero a una estructura de tipo CatalogoCursos
+ */
+void vaciarCatalogo(CatalogoCursos *catalogo) {
+    for (Curso *curso: catalogo->cursos) destruirCurso(curso);
+    catalogo->cursos.clear();
+    catalogo->seleccionado = -1;
+    catalogo->siguienteId = 1;
+    iniciarSketch(catalogo->sketchGlobal, K_SKETCH_NOTAS);
+    catalogo->versionesSketch.clear();
+}
+
+
+/**
+ * Libera toda la memoria del catálogo: las listas de alumnos de cada
+ * curso, los propios cursos y la estructura del catálogo
+ * @param catalogo Puntero a una estructura de tipo CatalogoCursos
+ */
+void destruirCatalogo(CatalogoCursos *catalogo) {
+    if (catalogo == nullptr) return;
+    vaciarCatalogo(catalogo);
+    delete catalogo;
+}
+
+
+/**
+ * Busca un curso por su nombre
+ * @param catalogo Puntero a una estructura constante de tipo CatalogoCursos
+ * @param nombre Nombre del curso buscado
+ * @return La posición del curso en el catálogo o -1 si no existe
+ */
+int buscarCurso(const CatalogoCursos *catalogo, const string &nombre) {
+    for (int i = 0; i < static_cast<int>(catalogo->cursos.size()); i++) {
+        if (catalogo->cursos[i]->nombre == nombre) return i;
+    }
+    return -1;
+}
+
+
+/**
+ * Añade al catálogo un curso con un identificador ya decidido, sin
+ * registrarlo en el diario. Se usa al reconstruir el catálogo
+ * @param catalogo Puntero a una estructura de tipo CatalogoCursos
+ * @param id Identificador del curso
+ * @param nombre Nombre del curso
+ * @param capacidad Número máximo de alumnos del curso
+ * @param tipoRecurso Tipo de recurso de memoria de la lista del curso
+ * @return Puntero al curso creado
+ */
+Curso *insertarCurso(CatalogoCursos *catalogo, const uint32_t id, const string &nombre, const int capacidad,
+                     const TipoRecurso tipoRecurso) {
+    Curso *curso = crearCurso(id, nombre, capacidad, tipoRecurso);
+    curso->lista->diario = catalogo->diario;
+    curso->lista->idCurso = id;
+    catalogo->cursos.push_back(curso);
+    if (catalogo->siguienteId <= id) catalogo->siguienteId = id + 1;
+    if (catalogo->seleccionado == -1) catalogo->seleccionado = 0;
+    return curso;
+}
+
+
+/**
+ * Da de alta un curso nuevo con su lista de alumnos vacía
+ * Si el catálogo estaba vacío el curso nuevo queda seleccionado
+ * @param catalogo Puntero a una estructura de tipo CatalogoCursos
+ * @param nombre Nombre del curso, no puede repetirse
+ * @param capacidad Número máximo de alumnos del curso
+ * @param tipoRecurso Tipo de recurso de memoria de la lista del curso
+ * @return Puntero a la lista de alumnos del curso o nulo si ya había un
+ * curso con ese nombre o el diario no admite más registros
+ */
+ListaAlumnos *addCurso(CatalogoCursos *catalogo, const string &nombre, const int capacidad,
+                       const TipoRecurso tipoRecurso) {
+    if (buscarCurso(catalogo, nombre) != -1) return nullptr;
+    if (catalogo->diario != nullptr) { // El curso solo se crea si queda registrado
+        string datos;
+        escribirBinario<uint32_t>(datos, catalogo->siguienteId);
+        escribirBinario<int32_t>(datos, capacidad);
+        escribirBinario<uint32_t>(datos, nombre.size());
+        datos += nombre;
+        escribirBinario<uint8_t>(datos, tipoRecurso);
+        if (not registrarOperacion(catalogo->diario, REGISTRO_CREAR_CURSO, datos)) return nullptr;
+    }
+    return insertarCurso(catalogo, catalogo->siguienteId, nombre, capacidad, tipoRecurso)->lista;
+}
+
+
+/**
+ * Elimina un curso del catálogo liberando su lista de alumnos
+ * Si el curso eliminado era el seleccionado pasa a seleccionarse el primero
+ * @param catalogo Puntero a una estructura de tipo CatalogoCursos
+ * @param nombre Nombre del curso a eliminar
+ * @return Verdadero si el curso existía y se ha eliminado, falso si no
+ * existía o el diario no admite más registros
+ */
+bool eliminarCurso(CatalogoCursos *catalogo, const string &nombre) {
+    const int posicion = buscarCurso(catalogo, nombre);
+    if (posicion == -1) return false;
+    if (catalogo->diario != nullptr) {
+        esperarPuntoControl(catalogo->diario); // Puede estar leyendo los alumnos del curso
+        string datos;
+        escribirBinario<uint32_t>(datos, catalogo->cursos[posicion]->id);
+        if (not registrarOperacion(catalogo->diario, REGISTRO_ELIMINAR_CURSO, datos)) return false;
+    }
+    destruirCurso(catalogo->cursos[posicion]);
+    catalogo->cursos.erase(catalogo->cursos.begin() + posicion);
+    if (catalogo->cursos.empty()) catalogo->seleccionado = -1;
+    else if (catalogo->seleccionado == posicion) catalogo->seleccionado = 0;
+    else if (catalogo->seleccionado > posicion) catalogo->seleccionado--;
+    return true;
+}
+
+
+/**
+ * Selecciona el curso sobre el que trabajará el menú
+ * @param catalogo Puntero a una estructura de tipo CatalogoCursos
+ * @param nombre Nombre del curso a seleccionar
+ * @return Verdadero si el curso existe y ha quedado seleccionado
+ */
+bool seleccionarCurso(CatalogoCursos *catalogo, const string &nombre) {
+    const int posicion = buscarCurso(catalogo, nombre);
+    if (posicion == -1) return false;
+    catalogo->seleccionado = posicion;
+    return true;
+}
+
+
+/**
+ * @param catalogo Puntero a una estructura constante de tipo CatalogoCursos
+ * @return El curso seleccionado o nulo si el catálogo está vacío
+ */
+Curso *getCursoSeleccionado(const CatalogoCursos *catalogo) {
+    if (catalogo == nullptr or catalogo->seleccionado == -1) return nullptr;
+    return catalogo->cursos[catalogo->seleccionado];
+}
+
+
+/**
+ * Busca un curso por su identificador
+ * @param catalogo Puntero a una estructura constante de tipo CatalogoCursos
+ * @param id Identificador del curso
+ * @return La posición del curso en el catálogo o -1 si no existe
+ */
+int buscarCursoPorId(const CatalogoCursos *catalogo, const uint32_t id) {
+    for (int i = 0; i < static_cast<int>(catalogo->cursos.size()); i++) {
+        if (catalogo->cursos[i]->id == id) return i;
+    }
+    return -1;
+}
+
+
+/**
+ * Aplica al catálogo un registro del diario ya validado
+ * @param catalogo Puntero a una estructura de tipo CatalogoCursos sin diario
+ * @param tipo Tipo de operación del registro
+ * @param datos Inicio de los datos del registro
+ * @param fin Final de los datos del registro
+ * @return Verdadero si el registro tenía un formato correcto
+ */
+bool aplicarRegistro(CatalogoCursos *catalogo, const uint8_t tipo, const char *datos, const char *fin) {
+    uint32_t id, longitud;
+    if (not leerBinario(datos, fin, id)) return false;
+    switch (tipo) {
+        case REGISTRO_CREAR_CURSO: {
+            int32_t capacidad;
+            if (not leerBinario(datos, fin, capacidad) or not leerBinario(datos, fin, longitud)) return false;
+            // Los registros anteriores a los recursos por curso acaban en el nombre
+            uint8_t tipoRecurso = RECURSO_GENERAL;
+            if (static_cast<size_t>(fin - datos) == longitud + sizeof(uint8_t)) {
+                memcpy(&tipoRecurso, fin - sizeof(uint8_t), sizeof(uint8_t));
+            } else if (fin - datos != longitud) {
+                return false;
+            }
+            if (capacidad <= 0 or tipoRecurso >= NUM_TIPOS_RECURSO) return false;
+            insertarCurso(catalogo, id, string(datos, longitud), capacidad, static_cast<TipoRecurso>(tipoRecurso));
+            return true;
+        }
+        case REGISTRO_ELIMINAR_CURSO: {
+            const int posicion = buscarCursoPorId(catalogo, id);
+            if (posicion != -1) eliminarCurso(catalogo, catalogo->cursos[posicion]->nombre);
+            return true;
+        }
+        case REGISTRO_ALTA_ALUMNO: {
+            float nota;
+            if (not leerBinario(datos, fin, nota) or not leerBinario(datos, fin, longitud)) return false;
+            if (fin - datos != longitud) return false;
+            const int posicion = buscarCursoPorId(catalogo, id);
+            if (posicion != -1) {
+                addAlumno(catalogo->cursos[posicion]->lista, string_view(datos, longitud), nota);
+            }
+            return true;
+        }
+        default: return false;
+    }
+}
+
+
+/**
+ * Reproduce en orden sobre el catálogo los registros de un segmento del
+ * diario. La lectura se detiene en el primer registro incompleto o con
+ * un CRC incorrecto (una escritura interrumpida por una caída) y el
+ * fichero se recorta hasta el último registro válido
+ * Los registros con número de secuencia menor o igual que ultimoLsn ya
+ * están incluidos en el punto de control cargado y se saltan
+ * @param ruta Ruta del fichero del segmento, puede no existir
+ * @param catalogo Puntero a una estructura de tipo CatalogoCursos sin diario
+ * @param ultimoLsn Entrada y salida con el número de secuencia del último
+ * registro aplicado
+ * @param completo Salida que indica si se ha leído el segmento entero
+ * @return Número de registros reproducidos
+ */
+uint64_t reproducirDiario(const string &ruta, CatalogoCursos *catalogo, uint64_t &ultimoLsn, bool &completo) {
+    completo = true;
+    ifstream fichero(ruta, ios::binary);
+    if (not fichero) return 0;
+    const string contenido{istreambuf_iterator<char>(fichero), istreambuf_iterator<char>()};
+    fichero.close();
+
+    uint64_t reproducidos = 0;
+    const char *datos = contenido.data();
+    const char *fin = datos + contenido.size();
+    const char *valido = datos;
+    uint32_t longitud, crc = 0;
+    while (leerBinario(datos, fin, longitud)) {
+        if (longitud < sizeof(uint8_t) + sizeof(uint64_t) or static_cast<size_t>(fin - datos) < longitud + sizeof(uint32_t)) break;
+        const char *cuerpo = datos;
+        datos += longitud;
+        leerBinario(datos, fin, crc);
+        if (crc != calcularCrc32(cuerpo, longitud)) break;
+        const uint8_t tipo = cuerpo[0];
+        uint64_t lsn;
+        memcpy(&lsn, cuerpo + sizeof(uint8_t), sizeof(uint64_t));
+        if (lsn > ultimoLsn) {
+            if (not aplicarRegistro(catalogo, tipo, cuerpo + sizeof(uint8_t) + sizeof(uint64_t), cuerpo + longitud)) break;
+            ultimoLsn = lsn;
+            reproducidos++;
+        }
+        valido = datos;
+    }
+    if (valido != contenido.data() + contenido.size()) {
+        completo = false;
+        cout << "Diario: descartados " << contenido.data() + contenido.size() - valido
+                << " bytes de un registro incompleto o corrupto" << endl;
+        filesystem::resize_file(ruta, valido - contenido.data());
+    }
+    return reproducidos;
+}
+
+
+/**
+ * Imagen del estado de un curso en el momento de un punto de control
+ * Como las listas solo crecen por el final y sus alumnos no cambian una
+ * vez añadidos, basta con recordar cuántos alumnos había: el hilo del
+ * punto de control puede leer esos primeros num alumnos mientras el
+ * programa sigue añadiendo otros detrás
+ */
+struct ImagenCurso {
+    uint32_t id;
+    string nombre;
+    int capacidad;
+    TipoRecurso tipoRecurso;
+    int num;
+    const Alumno *alumnos; // Alumnos del curso, que no se recolocan mientras se escriben
+};
+
+// Identificación del formato de fichero de los puntos de control
+const uint32_t MAGICO_PUNTO_CONTROL = 0x504B4350; // "PCKP"
+const uint32_t VERSION_PUNTO_CONTROL = 2; // La 1 no guarda el tipo de recurso de los cursos
+
+
+/**
+ * Escribe en disco la imagen de un punto de control. Se escribe primero a
+ * un fichero temporal que se sincroniza y se renombra, para que nunca haya
+ * una imagen a medias con el nombre definitivo. Después borra los
+ * segmentos del diario y puntos de control anteriores, que ya no hacen falta
+ * Formato: [magico u32][version u32][lsn u64][siguienteId u32][cursos u32]
+ * y por cada curso [id u32][capacidad i32][recurso u8][longitud u32][nombre][num u32]
+ * seguido de num veces [nota f32][longitud u32][nombre]; al final el CRC-32
+ * de todo lo anterior
+ * @param diario Puntero a una estructura de tipo Diario
+ * @param generacion Generación del punto de control (la del primer
+ * segmento del diario que no incluye)
+ * @param lsn Número de secuencia del último registro incluido
+ * @param siguienteId Próximo identificador de curso del catálogo
+ * @param cursos Imagen de los cursos
+ */
+void escribirPuntoControl(Diario *diario, const uint64_t generacion, const uint64_t lsn,
+                          const uint32_t siguienteId, const vector<ImagenCurso> cursos) {
+    const string ruta = getRutaPuntoControl(diario->rutaBase, generacion);
+    const string temporal = ruta + ".tmp";
+    const int fd = abrirParaEscribir(temporal);
+    bool correcto = fd >= 0;
+    string buffer;
+    uint32_t crc = 0;
+    auto vaciar = [&] {
+        crc = calcularCrc32(buffer.data(), buffer.size(), crc);
+        correcto = correcto and escribirTodo(fd, buffer.data(), buffer.size());
+        buffer.clear();
+    };
+    escribirBinario<uint32_t>(buffer, MAGICO_PUNTO_CONTROL);
+    escribirBinario<uint32_t>(buffer, VERSION_PUNTO_CONTROL);
+    escribirBinario<uint64_t>(buffer, lsn);
+    escribirBinario<uint32_t>(buffer, siguienteId);
+    escribirBinario<uint32_t>(buffer, cursos.size());
+    for (const ImagenCurso &curso: cursos) {
+        escribirBinario<uint32_t>(buffer, curso.id);
+        escribirBinario<int32_t>(buffer, curso.capacidad);
+        escribirBinario<uint8_t>(buffer, curso.tipoRecurso);
+        escribirBinario<uint32_t>(buffer, curso.nombre.size());
+        buffer += curso.nombre;
+        escribirBinario<uint32_t>(buffer, curso.num);
+        for (int i = 0; i < curso.num; i++) {
+            escribirBinario<float>(buffer, curso.alumnos[i].nota);
+            escribirBinario<uint32_t>(buffer, curso.alumnos[i].nombre.size());
+            buffer += curso.alumnos[i].nombre;
+            if (buffer.size() >= TAM_LOTE_DIARIO) vaciar();
+        }
+    }
+    vaciar();
+    escribirBinario<uint32_t>(buffer, crc);
+    correcto = correcto and escribirTodo(fd, buffer.data(), buffer.size()) and sincronizarDisco(fd);
+    if (fd >= 0) cerrarFichero(fd);
+
+    error_code error;
+    if (correcto) filesystem::rename(temporal, ruta, error);
+    if (not correcto or error) {
+        cerr << "Error escribiendo el punto de control " << ruta << endl;
+        filesystem::remove(temporal, error);
+    } else {
+        sincronizarDirectorio(ruta);
+        for (const uint64_t anterior: buscarGeneraciones(diario->rutaBase, ".ckpt.")) {
+            if (anterior < generacion) filesystem::remove(getRutaPuntoControl(diario->rutaBase, anterior), error);
+        }
+        for (const uint64_t anterior: buscarGeneraciones(diario->rutaBase, ".")) {
+            if (anterior < generacion) filesystem::remove(getRutaSegmento(diario->rutaBase, anterior), error);
+        }
+        if (generacion > 0) filesystem::remove(getRutaSegmento(diario->rutaBase, 0), error);
+    }
+    diario->puntoControlEnCurso = false;
+}
+
+
+/**
+ * Inicia un punto de control del catálogo sin detener las inserciones:
+ * pasa el diario a un segmento nuevo, toma la imagen de los cursos (solo
+ * cuántos alumnos tiene cada uno) y lanza un hilo que la escribe en disco
+ * Si ya hay un punto de control en curso no hace nada
+ * @param catalogo Puntero a una estructura constante de tipo CatalogoCursos
+ * con diario
+ * @return Verdadero si se ha iniciado el punto de control
+ */
+bool iniciarPuntoControl(const CatalogoCursos *catalogo) {
+    Diario *diario = catalogo->diario;
+    if (diario == nullptr or diario->puntoControlEnCurso) return false;
+    esperarPuntoControl(diario);
+    if (not rotarDiario(diario)) return false;
+    vector<ImagenCurso> cursos;
+    for (const Curso *curso: catalogo->cursos) {
+        cursos.push_back({curso->id, curso->nombre, curso->lista->capacidad, curso->tipoRecurso, curso->lista->num,
+                          curso->lista->alumnos.data()});
+    }
+    uint64_t lsn;
+    {
+        lock_guard<mutex> bloqueo(diario->cerrojo);
+        lsn = diario->siguienteLsn - 1;
+        diario->registrosPuntoControl = 0;
+    }
+    diario->puntoControlEnCurso = true;
+    diario->puntoControl = thread(escribirPuntoControl, diario, diario->generacion, lsn, catalogo->siguienteId,
+                                  std::move(cursos));
+    return true;
+}
+
+
+/**
+ * Carga en un catálogo vacío la imagen de un punto de control,
+ * comprobando su formato y su CRC. Falla también si algún alumno no se
+ * puede añadir a su curso (más alumnos que capacidad)
+ * @param ruta Ruta del fichero del punto de control
+ * @param catalogo Puntero a una estructura de tipo CatalogoCursos vacío y sin diario
+ * @param lsn Salida con el número de secuencia del último registro incluido
+ * @return Verdadero si la imagen es válida y se ha cargado
+ */
+bool cargarPuntoControl(const string &ruta, CatalogoCursos *catalogo, uint64_t &lsn) {
+    ifstream fichero(ruta, ios::binary);
+    if (not fichero) return false;
+    const string contenido{istreambuf_iterator<char>(fichero), istreambuf_iterator<char>()};
+    if (contenido.size() < sizeof(uint32_t)) return false;
+    const char *datos = contenido.data();
+    const char *fin = datos + contenido.size() - sizeof(uint32_t);
+    uint32_t crc, magico, version, siguienteId, numCursos;
+    memcpy(&crc, fin, sizeof(uint32_t));
+    if (crc != calcularCrc32(datos, fin - datos)) return false;
+    if (not leerBinario(datos, fin, magico) or magico != MAGICO_PUNTO_CONTROL or
+        not leerBinario(datos, fin, version) or version < 1 or version > VERSION_PUNTO_CONTROL or
+        not leerBinario(datos, fin, lsn) or not leerBinario(datos, fin, siguienteId) or
+        not leerBinario(datos, fin, numCursos)) {
+        return false;
+    }
+    for (uint32_t c = 0; c < numCursos; c++) {
+        uint32_t id, longitud, num;
+        int32_t capacidad;
+        uint8_t tipoRecurso = RECURSO_GENERAL;
+        if (not leerBinario(datos, fin, id) or not leerBinario(datos, fin, capacidad) or
+            (version >= 2 and not leerBinario(datos, fin, tipoRecurso)) or
+            not leerBinario(datos, fin, longitud) or static_cast<size_t>(fin - datos) < longitud or
+            capacidad <= 0 or tipoRecurso >= NUM_TIPOS_RECURSO) {
+            return false;
+        }
+        ListaAlumnos *lista = insertarCurso(catalogo, id, string(datos, longitud), capacidad,
+                                           static_cast<TipoRecurso>(tipoRecurso))->lista;
+        datos += longitud;
+        if (not leerBinario(datos, fin, num)) return false;
+        for (uint32_t i = 0; i < num; i++) {
+            float nota;
+            if (not leerBinario(datos, fin, nota) or not leerBinario(datos, fin, longitud) or
+                static_cast<size_t>(fin - datos) < longitud) {
+                return false;
+            }
+            if (not addAlumno(lista, string_view(datos, longitud), nota)) return false;
+            datos += longitud;
+        }
+    }
+    catalogo->siguienteId = max(catalogo->siguienteId, siguienteId);
+    return true;
+}
+
+
+/**
+ * Reconstruye el catálogo al arrancar: carga el punto de control válido
+ * más reciente y reproduce solo los segmentos del diario posteriores a él
+ * Muestra por consola cuánto se ha recuperado y cuánto ha tardado
+ * @param rutaBase Ruta del diario
+ * @param catalogo Puntero a una estructura de tipo CatalogoCursos vacío y sin diario
+ * @param generacion Salida con la generación del segmento en el que
+ * hay que seguir escribiendo
+ * @param ultimoLsn Salida con el número de secuencia del último registro
+ * recuperado (0 si no hay ninguno)
+ */
+void recuperarCatalogo(const string &rutaBase, CatalogoCursos *catalogo, uint64_t &generacion,
+                       uint64_t &ultimoLsn) {
+    const auto inicio = chrono::steady_clock::now();
+    ultimoLsn = 0;
+    generacion = 0;
+    const vector<uint64_t> puntosControl = buscarGeneraciones(rutaBase, ".ckpt.");
+    for (auto it = puntosControl.rbegin(); it != puntosControl.rend(); ++it) {
+        if (cargarPuntoControl(getRutaPuntoControl(rutaBase, *it), catalogo, ultimoLsn)) {
+            generacion = *it;
+            break;
+        }
+        cout << "Punto de control " << *it << " no valido, se descarta" << endl;
+        vaciarCatalogo(catalogo); // Deja el catálogo vacío antes de probar otro
+        ultimoLsn = 0;
+    }
+    int alumnosPuntoControl = 0;
+    for (const Curso *curso: catalogo->cursos) alumnosPuntoControl += curso->lista->num;
+
+    vector<uint64_t> segmentos = buscarGeneraciones(rutaBase, ".");
+    if (filesystem::exists(rutaBase)) segmentos.insert(segmentos.begin(), 0);
+    uint64_t reproducidos = 0;
+    bool completo = true;
+    for (const uint64_t segmento: segmentos) {
+        if (segmento < generacion) continue;
+        if (not completo) {
+            cout << "Diario: se descarta el segmento " << segmento << " posterior a un registro corrupto" << endl;
+            filesystem::remove(getRutaSegmento(rutaBase, segmento));
+            continue;
+        }
+        reproducidos += reproducirDiario(getRutaSegmento(rutaBase, segmento), catalogo, ultimoLsn, completo);
+        generacion = segmento;
+    }
+    const auto ms = chrono::duration_cast<chrono::microseconds>(chrono::steady_clock::now() - inicio).count() / 1000.0;
+    cout << "Recuperacion: " << alumnosPuntoControl << " alumnos del punto de control y "
+            << reproducidos << " operaciones del diario en " << ms << " ms" << endl;
+}
+
+
+/**
+ * Asocia un diario al catálogo y a las listas de todos sus cursos para
+ * que a partir de ahora se registren todas las operaciones
+ * @param catalogo Puntero a una estructura de tipo CatalogoCursos
+ * @param diario Puntero a una estructura de tipo Diario o nulo para
+ * dejar de registrar
+ */
+void conectarDiario(CatalogoCursos *catalogo, Diario *diario) {
+    catalogo->diario = diario;
+    for (Curso *curso: catalogo->cursos) curso->lista->diario = diario;
+}
+
+
+/**
+ * Recalcula en paralelo los agregados de todos los cursos del catálogo
+ * que no los tengan ya calculados. Cada curso pendiente es una tarea del
+ * pool de hilos, que a su vez reparte los cursos grandes en bloques;
+ * cada tarea solo escribe en los agregados de su propio curso
+ * @param catalogo Puntero a una estructura constante de tipo CatalogoCursos
+ */
+void actualizarAgregadosCatalogo(const CatalogoCursos *catalogo) {
+    vector<ListaAlumnos *> pendientes;
+    for (Curso *curso: catalogo->cursos) {
+        if (curso->lista->cache.agregados.version != curso->lista->version) pendientes.push_back(curso->lista);
+    }
+    paraCada(0, static_cast<int64_t>(pendientes.size()), 1, [&pendientes](const int64_t desde, const int64_t hasta) {
+        for (int64_t i = desde; i < hasta; i++) actualizarAgregados(pendientes[i]);
+    });
+}
+
+
+/**
+ * Resultado de las consultas que abarcan todos los cursos del catálogo
+ */
+struct InformeGlobal {
+    int numAlumnos;
+    double sumaNotas;
+    const Alumno *maxNota; // Mejor alumno de todos los cursos o nulo si no hay alumnos
+    const Curso *cursoMaxNota; // Curso al que pertenece maxNota
+    vector<const Curso *> cursosConSuspensos;
+    const SketchKLL *sketchNotas; // Resumen global del catálogo, válido mientras no cambie
+};
+
+
+/**
+ * Mezcla los resúmenes de notas de todos los cursos en el resumen global
+ * del catálogo, solo si algún curso se ha creado, eliminado o modificado
+ * desde la última mezcla
+ * @param catalogo Puntero a una estructura constante de tipo CatalogoCursos
+ * @return Referencia constante al resumen global
+ */
+const SketchKLL &actualizarSketchGlobal(const CatalogoCursos *catalogo) {
+    vector<pair<uint32_t, uint64_t>> versiones;
+    versiones.reserve(catalogo->cursos.size());
+    for (const Curso *curso: catalogo->cursos) versiones.emplace_back(curso->id, curso->lista->version);
+    if (versiones != catalogo->versionesSketch) {
+        iniciarSketch(catalogo->sketchGlobal, K_SKETCH_NOTAS);
+        for (const Curso *curso: catalogo->cursos) mezclarSketch(catalogo->sketchGlobal, curso->lista->sketchNotas);
+        catalogo->versionesSketch = std::move(versiones);
+    }
+    return catalogo->sketchGlobal;
+}
+
+
+/**
+ * Calcula el informe global del catálogo: nota media de todos los alumnos,
+ * mejor alumno, cursos que tienen algún alumno suspenso y el resumen de
+ * las notas de todos los cursos para los percentiles
+ * Los agregados de cada curso se calculan en paralelo y después se
+ * combinan; los resúmenes de notas solo se mezclan si han cambiado
+ * @param catalogo Puntero a una estructura constante de tipo CatalogoCursos
+ * @return Estructura InformeGlobal con los resultados
+ */
+InformeGlobal getInformeGlobal(const CatalogoCursos *catalogo) {
+    actualizarAgregadosCatalogo(catalogo);
+    InformeGlobal informe{};
+    informe.sketchNotas = &actualizarSketchGlobal(catalogo);
+    for (const Curso *curso: catalogo->cursos) {
+        const AgregadosLista &agregados = curso->lista->cache.agregados;
+        informe.numAlumnos += curso->lista->num;
+        informe.sumaNotas += agregados.sumaNotas;
+        if (agregados.maxNota != nullptr and
+            (informe.maxNota == nullptr or agregados.maxNota->nota > informe.maxNota->nota)) {
+            informe.maxNota = agregados.maxNota;
+            informe.cursoMaxNota = curso;
+        }
+        if (agregados.numSuspensos > 0) informe.cursosConSuspensos.push_back(curso);
+    }
+    return informe;
+}
+
+
+/**
+ * Estructura para consultar una lista de alumnos guardada en disco sin
+ * cargar los nombres: las notas se leen todas a memoria al abrirla y los
+ * nombres se leen del fichero solo cuando se necesitan (al imprimir o
+ * buscar un alumno concreto), de modo que la memoria necesaria es de
+ * 4 bytes por alumno aunque la lista tenga cientos de millones
+ *
+ * Formato del fichero: [magico u32][version u32][num u64], las num notas
+ * (f32), un índice de num + 1 posiciones (u64) relativas al inicio de la
+ * zona de nombres, donde el alumno i ocupa de indice[i] a indice[i + 1],
+ * y por último los nombres uno detrás de otro
+ */
+struct ListaPaginada {
+    int fd;
+    int64_t num;
+    float *notas; // Columna de notas residente en memoria
+    uint64_t inicioIndice; // Posición del índice de nombres en el fichero
+    uint64_t inicioNombres; // Posición de la zona de nombres en el fichero
+    uint64_t bytesNombres; // Tamaño de la zona de nombres
+};
+
+// Identificación del formato de fichero de las listas paginadas
+const uint32_t MAGICO_LISTA_PAGINADA = 0x54534C50; // "PLST"
+const uint32_t VERSION_LISTA_PAGINADA = 1;
+const uint64_t CABECERA_LISTA_PAGINADA = 2 * sizeof(uint32_t) + sizeof(uint64_t);
+
+
+// Bytes que se acumulan como mucho antes de escribirlos al guardar una lista paginada
+const size_t TAM_BUFFER_LISTA_PAGINADA = 1 << 20;
+
+
+/**
+ * Escribe el buffer en el fichero si ha llegado al tamaño indicado y lo vacía
+ * @param fichero Fichero donde se escribe
+ * @param buffer Bytes pendientes de escribir
+ * @param minimo Tamaño a partir del cual se escribe
+ */
+void volcarSiLleno(ofstream &fichero, string &buffer, const size_t minimo) {
+    if (buffer.size() < minimo) return;
+    fichero.write(buffer.data(), static_cast<streamsize>(buffer.size()));
+    buffer.clear();
+}
+
+
+/**
+ * Guarda una lista de alumnos en el formato de lista paginada
+ * La columna de notas y el índice se escriben por tramos, de modo que la
+ * memoria que hace falta no depende del número de alumnos
+ * @param lista Puntero a una estructura constante de tipo ListaAlumnos
+ * @param ruta Ruta del fichero a crear
+ * @return Verdadero si el fichero se ha escrito completo
+ */
+bool guardarListaPaginada(const ListaAlumnos *lista, const string &ruta) {
+    ofstream fichero(ruta, ios::binary | ios::trunc);
+    if (not fichero) return false;
+    string buffer;
+    buffer.reserve(TAM_BUFFER_LISTA_PAGINADA + sizeof(uint64_t));
+    escribirBinario<uint32_t>(buffer, MAGICO_LISTA_PAGINADA);
+    escribirBinario<uint32_t>(buffer, VERSION_LISTA_PAGINADA);
+    escribirBinario<uint64_t>(buffer, lista->num);
+    for (int i = 0; i < lista->num; i++) {
+        escribirBinario<float>(buffer, lista->alumnos[i].nota);
+        volcarSiLleno(fichero, buffer, TAM_BUFFER_LISTA_PAGINADA);
+    }
+    uint64_t posicion = 0;
+    for (int i = 0; i < lista->num; i++) {
+        escribirBinario<uint64_t>(buffer, posicion);
+        posicion += lista->alumnos[i].nombre.size();
+        volcarSiLleno(fichero, buffer, TAM_BUFFER_LISTA_PAGINADA);
+    }
+    escribirBinario<uint64_t>(buffer, posicion);
+    volcarSiLleno(fichero, buffer, 0);
+    for (int i = 0; i < lista->num; i++) {
+        fichero.write(lista->alumnos[i].nombre.data(), static_cast<streamsize>(lista->alumnos[i].nombre.size()));
+    }
+    return static_cast<bool>(fichero);
+}
+
+
+/**
+ * Cierra el fichero de una lista paginada y libera su memoria
+ * @param lista Puntero a una estructura de tipo ListaPaginada
+ */
+void cerrarListaPaginada(ListaPaginada *lista) {
+    if (lista == nullptr) return;
+    cerrarFichero(lista->fd);
+    delete[] lista->notas;
+    delete lista;
+}
+
+
+/**
+ * Abre una lista paginada leyendo a memoria únicamente su columna de notas
+ * Antes de reservar memoria comprueba que la cabecera y el final del
+ * índice cuadren con el tamaño del fichero, y después que todas las
+ * notas estén entre 0 y 10
+ * @param ruta Ruta del fichero
+ * @param cargarNotas Falso para no leer la columna de notas (notas queda
+ * nulo), cuando quien abre la lista la recorre del fichero y comprueba
+ * las notas él mismo
+ * @return Puntero a la estructura ListaPaginada o nulo si el fichero no
+ * existe o no tiene el formato correcto
+ */
+ListaPaginada *abrirListaPaginada(const string &ruta, const bool cargarNotas = true) {
+    const int fd = abrirParaLeer(ruta);
+    if (fd < 0) return nullptr;
+    const int64_t tamFichero = getTamFichero(fd);
+    char cabecera[CABECERA_LISTA_PAGINADA];
+    uint32_t magico, version;
+    uint64_t num, finNombres;
+    if (tamFichero < 0 or not leerEn(fd, 0, cabecera, sizeof(cabecera))) {
+        cerrarFichero(fd);
+        return nullptr;
+    }
+    memcpy(&magico, cabecera, sizeof(uint32_t));
+    memcpy(&version, cabecera + sizeof(uint32_t), sizeof(uint32_t));
+    memcpy(&num, cabecera + 2 * sizeof(uint32_t), sizeof(uint64_t));
+    const uint64_t tam = static_cast<uint64_t>(tamFichero);
+    const uint64_t maximo = (tam - CABECERA_LISTA_PAGINADA) / (sizeof(float) + sizeof(uint64_t));
+    if (magico != MAGICO_LISTA_PAGINADA or version != VERSION_LISTA_PAGINADA or num > maximo) {
+        cerrarFichero(fd);
+        return nullptr;
+    }
+    const uint64_t inicioIndice = CABECERA_LISTA_PAGINADA + num * sizeof(float);
+    const uint64_t inicioNombres = inicioIndice + (num + 1) * sizeof(uint64_t);
+    if (inicioNombres > tam or
+        not leerEn(fd, inicioNombres - sizeof(uint64_t), reinterpret_cast<char *>(&finNombres), sizeof(finNombres)) or
+        finNombres != tam - inicioNombres) {
+        cerrarFichero(fd);
+        return nullptr;
+    }
+    ListaPaginada *lista = new ListaPaginada{fd, static_cast<int64_t>(num), nullptr, inicioIndice,
+                                             inicioNombres, finNombres};
+    if (not cargarNotas) return lista;
+    lista->notas = new float[num];
+    if (not leerEn(fd, CABECERA_LISTA_PAGINADA, reinterpret_cast<char *>(lista->notas), num * sizeof(float)) or
+        not all_of(lista->notas, lista->notas + num, esNotaValida)) {
+        cerrarListaPaginada(lista);
+        return nullptr;
+    }
+    return lista;
+}
+
+
+/**
+ * Lee del fichero el nombre de un alumno de una lista paginada
+ * @param lista Puntero a una estructura constante de tipo ListaPaginada
+ * @param i Posición del alumno en la lista
+ * @return El nombre del alumno o un texto vacío si no se ha podido leer
+ */
+string getNombre(const ListaPaginada *lista, const int64_t i) {
+    uint64_t limites[2];
+    if (i < 0 or i >= lista->num or
+        not leerEn(lista->fd, lista->inicioIndice + i * sizeof(uint64_t), reinterpret_cast<char *>(limites),
+                   sizeof(limites))) {
+        return "";
+    }
+    if (limites[0] > limites[1] or limites[1] > lista->bytesNombres) return "";
+    string nombre(limites[1] - limites[0], '\0');
+    if (not leerEn(lista->fd, lista->inicioNombres + limites[0], nombre.data(), nombre.size())) return "";
+    return nombre;
+}
+
+
+/**
+ * Calcula la nota media de los alumnos de una lista paginada usando
+ * solo la columna de notas
+ * @param lista Puntero a una estructura constante de tipo ListaPaginada
+ * @return La nota media o 0 si la lista está vacía
+ */
+float getNotaMedia(const ListaPaginada *lista) {
+    if (lista == nullptr or lista->num == 0) return 0;
+    return static_cast<float>(kernelsNotas->sumar(lista->notas, lista->num) / static_cast<double>(lista->num));
+}
+
+
+/**
+ * Resume las notas de una lista paginada para calcular percentiles
+ * aproximados: cada tarea del pool de hilos resume un bloque de la
+ * columna de notas y los resúmenes de los bloques se mezclan
+ * @param lista Puntero a una estructura constante de tipo ListaPaginada
+ * @param sketch Referencia al resumen, que se vacía antes
+ */
+void resumirNotas(const ListaPaginada *lista, SketchKLL &sketch) {
+    iniciarSketch(sketch, K_SKETCH_NOTAS);
+    if (lista == nullptr or lista->num == 0) return;
+    const int64_t TAM_BLOQUE = 1 << 20;
+    vector<SketchKLL> parciales((lista->num + TAM_BLOQUE - 1) / TAM_BLOQUE);
+    paraCada(0, static_cast<int64_t>(parciales.size()), 1, [lista, &parciales, TAM_BLOQUE](const int64_t desde,
+                                                                                         const int64_t hasta) {
+        for (int64_t b = desde; b < hasta; b++) {
+            iniciarSketch(parciales[b], K_SKETCH_NOTAS);
+            const int64_t fin = min(lista->num, (b + 1) * TAM_BLOQUE);
+            for (int64_t i = b * TAM_BLOQUE; i < fin; i++) actualizarSketch(parciales[b], lista->notas[i]);
+        }
+    });
+    for (const SketchKLL &parcial: parciales) mezclarSketch(sketch, parcial);
+}
+
+
+/**
+ * Busca el alumno con mayor nota de una lista paginada
+ * @param lista Puntero a una estructura constante de tipo ListaPaginada
+ * @return La posición del primer alumno con la nota más alta o -1 si la
+ * lista está vacía
+ */
+int64_t getAlumnoMaxNota(const ListaPaginada *lista) {
+    if (lista == nullptr) return -1;
+    return kernelsNotas->posicionMaxima(lista->notas, lista->num);
+}
+
+
+/**
+ * Comprueba si en una lista paginada hay algún alumno con nota inferior a 5
+ * La columna de notas se recorre por tramos para parar en el primero que
+ * tenga un suspenso
+ * @param lista Puntero a una estructura constante de tipo ListaPaginada
+ * @return Verdadero si hay al menos un alumno suspenso
+ */
+bool existeAlumnoSuspenso(const ListaPaginada *lista) {
+    if (lista == nullptr) return false;
+    for (int64_t i = 0; i < lista->num; i += TAM_TRAMO_SUSPENSOS) {
+        if (kernelsNotas->contarMenores(lista->notas + i, min(TAM_TRAMO_SUSPENSOS, lista->num - i), 5) > 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+
+/**
+ * Interpreta el texto de una nota, admitiendo espacios alrededor
+ * @param texto Texto con la nota
+ * @param nota Salida con la nota
+ * @return Verdadero si el texto es un número entre 0 y 10
+ */
+bool interpretarNota(string_view texto, float &nota) {
+    while (not texto.empty() and (texto.front() == ' ' or texto.front() == '\t')) texto.remove_prefix(1);
+    while (not texto.empty() and (texto.back() == ' ' or texto.back() == '\t' or texto.back() == '\r')) {
+        texto.remove_suffix(1);
+    }
+    const auto [fin, error] = from_chars(texto.data(), texto.data() + texto.size(), nota);
+    return error == errc() and fin == texto.data() + texto.size() and esNotaValida(nota);
+}
+
+
+/**
+ * Interpreta una línea de un fichero CSV de alumnos con la forma
+ * nombre,nota. El separador es la última coma, así que el nombre puede
+ * contener comas. Se aplican las mismas reglas que en inputNombre e
+ * inputNota: el nombre no puede quedar vacío y la nota debe estar entre 0 y 10
+ * @param linea Texto de la línea sin el salto de línea
+ * @param nombre Salida con el nombre del alumno
+ * @param nota Salida con la nota del alumno
+ * @return Verdadero si la línea es un alumno válido
+ */
+bool interpretarLineaAlumno(string_view linea, string_view &nombre, float &nota) {
+    if (not linea.empty() and linea.back() == '\r') linea.remove_suffix(1);
+    const size_t coma = linea.rfind(',');
+    if (coma == string_view::npos) return false;
+    nombre = linea.substr(0, coma);
+    return interpretarNota(linea.substr(coma + 1), nota) and esNombreValido(nombre);
+}
+
+
+// Bytes del nombre que caben dentro de un AlumnoFijo
+const size_t MAX_NOMBRE_FIJO = 59;
+// Valor del campo longitud de un AlumnoFijo cuyo nombre no cabe y está en la zona de desbordados
+const uint8_t NOMBRE_DESBORDADO = 0xFF;
+
+
+/**
+ * Registro de alumno de tamaño fijo (64 bytes, una línea de caché) sin
+ * memoria dinámica, que se puede copiar, mover y escribir a disco tal cual
+ * con memcpy o write
+ * El campo longitud es el número de bytes del nombre guardados en el campo
+ * nombre; si el nombre tiene más de MAX_NOMBRE_FIJO bytes, longitud vale
+ * NOMBRE_DESBORDADO y el campo nombre guarda en sus 8 primeros bytes la
+ * posición y la longitud (u32) del nombre en una zona aparte de nombres
+ * desbordados, que también es un simple "array" de bytes
+ */
+struct alignas(64) AlumnoFijo {
+    float nota;
+    uint8_t longitud;
+    char nombre[MAX_NOMBRE_FIJO];
+};
+
+static_assert(sizeof(AlumnoFijo) == 64, "AlumnoFijo tiene que ocupar una línea de caché");
+static_assert(is_trivially_copyable_v<AlumnoFijo>, "AlumnoFijo tiene que poder copiarse con memcpy");
+
+
+/**
+ * Estructura para manejar una tabla de alumnos de tamaño fijo
+ * El campo registros tiene los alumnos y el campo desbordados los nombres
+ * que no caben en un AlumnoFijo, uno detrás de otro
+ */
+struct TablaAlumnosFijos {
+    vector<AlumnoFijo> registros;
+    string desbordados;
+};
+
+
+/**
+ * Rellena un registro de alumno de tamaño fijo. Si el nombre no cabe en
+ * el registro, solo guarda dónde está en la zona de desbordados: copiarlo
+ * allí es cosa de quien llama
+ * @param registro Referencia al registro
+ * @param nombre Nombre del alumno
+ * @param nota Nota del alumno
+ * @param desplazamiento Posición del nombre en la zona de desbordados si no cabe
+ */
+void rellenarAlumnoFijo(AlumnoFijo &registro, const string_view nombre, const float nota,
+                        const uint32_t desplazamiento) {
+    registro = AlumnoFijo{}; // Sin restos de otro alumno en los bytes del nombre que no se usan
+    registro.nota = nota;
+    if (nombre.size() <= MAX_NOMBRE_FIJO) {
+        registro.longitud = static_cast<uint8_t>(nombre.size());
+        memcpy(registro.nombre, nombre.data(), nombre.size());
+        return;
+    }
+    const uint32_t longitud = static_cast<uint32_t>(nombre.size());
+    registro.longitud = NOMBRE_DESBORDADO;
+    memcpy(registro.nombre, &desplazamiento, sizeof(uint32_t));
+    memcpy(registro.nombre + sizeof(uint32_t), &longitud, sizeof(uint32_t));
+}
+
+
+/**
+ * Añade un alumno al final de una tabla de alumnos de tamaño fijo,
+ * guardando el nombre en la zona de desbordados si no cabe en el registro
+ * @param tabla Referencia a la tabla
+ * @param nombre Nombre del alumno
+ * @param nota Nota del alumno
+ */
+void addAlumnoFijo(TablaAlumnosFijos &tabla, const string_view nombre, const float nota) {
+    rellenarAlumnoFijo(tabla.registros.emplace_back(), nombre, nota, static_cast<uint32_t>(tabla.desbordados.size()));
+    if (nombre.size() > MAX_NOMBRE_FIJO) tabla.desbordados += nombre;
+}
+
+
+/**
+ * Devuelve el nombre de un alumno de una tabla de alumnos de tamaño fijo
+ * @param tabla Referencia constante a la tabla
+ * @param i Posición del alumno en la tabla
+ * @return Vista del nombre, válida mientras no cambie la tabla
+ */
+string_view getNombre(const TablaAlumnosFijos &tabla, const size_t i) {
+    const AlumnoFijo &registro = tabla.registros[i];
+    if (registro.longitud != NOMBRE_DESBORDADO) return {registro.nombre, registro.longitud};
+    uint32_t desplazamiento, longitud;
+    memcpy(&desplazamiento, registro.nombre, sizeof(uint32_t));
+    memcpy(&longitud, registro.nombre + sizeof(uint32_t), sizeof(uint32_t));
+    return string_view(tabla.desbordados).substr(desplazamiento, longitud);
+}
+
+
+/**
+ * Pasa los alumnos de una lista a una tabla de alumnos de tamaño fijo
+ * @param lista Puntero a una estructura constante de tipo ListaAlumnos
+ * @return La tabla con los alumnos en el orden de la lista
+ */
+TablaAlumnosFijos crearTablaFija(const ListaAlumnos *lista) {
+    TablaAlumnosFijos tabla;
+    tabla.registros.reserve(lista->num);
+    for (int i = 0; i < lista->num; i++) addAlumnoFijo(tabla, lista->alumnos[i].nombre, lista->alumnos[i].nota);
+    return tabla;
+}
+
+
+// Identificación del formato de fichero de las tablas de alumnos de tamaño fijo
+const uint32_t MAGICO_TABLA_FIJA = 0x4A494641; // "AFIJ"
+const uint32_t VERSION_TABLA_FIJA = 1;
+
+
+/**
+ * Prepara la cabecera de un fichero de tabla de alumnos de tamaño fijo
+ * @param num Número de registros
+ * @param bytesDesbordados Bytes de la zona de desbordados
+ * @return Los bytes de la cabecera
+ */
+string crearCabeceraTablaFija(const uint64_t num, const uint64_t bytesDesbordados) {
+    string cabecera;
+    escribirBinario<uint32_t>(cabecera, MAGICO_TABLA_FIJA);
+    escribirBinario<uint32_t>(cabecera, VERSION_TABLA_FIJA);
+    escribirBinario<uint64_t>(cabecera, num);
+    escribirBinario<uint64_t>(cabecera, bytesDesbordados);
+    return cabecera;
+}
+
+
+/**
+ * Guarda una tabla de alumnos de tamaño fijo en un fichero binario:
+ * [magico u32][version u32][num u64][bytes de desbordados u64], los num
+ * registros de 64 bytes tal como están en memoria y la zona de desbordados
+ * @param tabla Referencia constante a la tabla
+ * @param ruta Ruta del fichero a crear
+ * @return Verdadero si el fichero se ha escrito completo
+ */
+bool guardarTablaFija(const TablaAlumnosFijos &tabla, const string &ruta) {
+    ofstream fichero(ruta, ios::binary | ios::trunc);
+    if (not fichero) return false;
+    const string cabecera = crearCabeceraTablaFija(tabla.registros.size(), tabla.desbordados.size());
+    fichero.write(cabecera.data(), static_cast<streamsize>(cabecera.size()));
+    fichero.write(reinterpret_cast<const char *>(tabla.registros.data()),
+                  static_cast<streamsize>(tabla.registros.size() * sizeof(AlumnoFijo)));
+    fichero.write(tabla.desbordados.data(), static_cast<streamsize>(tabla.desbordados.size()));
+    return static_cast<bool>(fichero);
+}
+
+
+/**
+ * Carga una tabla de alumnos de tamaño fijo de un fichero escrito con
+ * guardarTablaFija, leyendo los registros directamente en su "array"
+ * Comprueba que la cabecera cuadre con el tamaño del fichero antes de
+ * reservar memoria y que los nombres desbordados estén dentro de su zona
+ * @param ruta Ruta del fichero
+ * @param tabla Referencia a la tabla donde se cargan los alumnos
+ * @return Verdadero si el fichero existe, tiene el formato correcto y se ha leído entero
+ */
+bool cargarTablaFija(const string &ruta, TablaAlumnosFijos &tabla) {
+    ifstream fichero(ruta, ios::binary);
+    if (not fichero) return false;
+    error_code error;
+    const uintmax_t tamFichero = filesystem::file_size(ruta, error);
+    if (error) return false;
+    char cabecera[2 * sizeof(uint32_t) + 2 * sizeof(uint64_t)];
+    if (not fichero.read(cabecera, sizeof(cabecera))) return false;
+    const char *lectura = cabecera;
+    uint32_t magico, version;
+    uint64_t num, bytesDesbordados;
+    const char *fin = cabecera + sizeof(cabecera);
+    leerBinario(lectura, fin, magico);
+    leerBinario(lectura, fin, version);
+    leerBinario(lectura, fin, num);
+    leerBinario(lectura, fin, bytesDesbordados);
+    if (magico != MAGICO_TABLA_FIJA or version != VERSION_TABLA_FIJA or num > INT_MAX or
+        bytesDesbordados > UINT32_MAX or sizeof(cabecera) + num * sizeof(AlumnoFijo) + bytesDesbordados != tamFichero) {
+        return false;
+    }
+    tabla.registros.resize(num);
+    tabla.desbordados.resize(bytesDesbordados);
+    fichero.read(reinterpret_cast<char *>(tabla.registros.data()), static_cast<streamsize>(num * sizeof(AlumnoFijo)));
+    fichero.read(tabla.desbordados.data(), static_cast<streamsize>(bytesDesbordados));
+    if (not fichero) return false;
+    for (const AlumnoFijo &registro: tabla.registros) {
+        if (registro.longitud == NOMBRE_DESBORDADO) {
+            uint32_t desplazamiento, longitud;
+            memcpy(&desplazamiento, registro.nombre, sizeof(uint32_t));
+            memcpy(&longitud, registro.nombre + sizeof(uint32_t), sizeof(uint32_t));
+            if (static_cast<uint64_t>(desplazamiento) + longitud > bytesDesbordados) return false;
+        } else if (registro.longitud > MAX_NOMBRE_FIJO) {
+            return false;
+        }
+    }
+    return true;
+}
+
+
+/**
+ * Resumen de la carga de un fichero de alumnos
+ */
+struct ResultadoCarga {
+    int64_t lineas; // Líneas no vacías leídas
+    int64_t cargados; // Alumnos añadidos a la lista
+    int64_t invalidos; // Líneas que no son un alumno válido
+    int64_t sinHueco; // Alumnos válidos que no caben en la lista
+    int64_t duplicados; // Alumnos descartados porque su nombre ya estaba en la lista
+    int64_t sinDiario; // Alumnos descartados porque el diario no admite más registros
+    vector<int64_t> lineasInvalidas; // Números de las primeras líneas no válidas
+    double segundos;
+};
+
+// Máximo de números de línea no válida que se guardan en ResultadoCarga
+const size_t MAX_LINEAS_INVALIDAS = 10;
+
+
+/**
+ * Datos de un alumno producidos por una fuente. El nombre apunta a memoria
+ * de la fuente, por lo que solo es válido hasta que se le pide otro alumno
+ */
+struct RegistroAlumno {
+    string_view nombre;
+    float nota;
+};
+
+
+/**
+ * Alumnos leídos de un trozo de un fichero CSV por un hilo
+ * Los nombres apuntan al fichero proyectado en memoria: los alumnos se
+ * crean al añadirlos a la lista, con su recurso de memoria, que no tiene
+ * por qué admitir reservas desde varios hilos
+ */
+struct TrozoCarga {
+    const char *inicio;
+    const char *fin;
+    vector<RegistroAlumno> alumnos;
+    int64_t lineas; // Líneas del trozo, incluidas las vacías
+    int64_t noVacias;
+    vector<int64_t> invalidas; // Números de línea dentro del trozo
+};
+
+
+/**
+ * Interpreta todas las líneas de un trozo de fichero guardando los datos
+ * de un alumno por cada línea válida
+ * @param trozo Puntero a una estructura de tipo TrozoCarga
+ */
+void interpretarTrozo(TrozoCarga *trozo) {
+    const char *linea = trozo->inicio;
+    while (linea < trozo->fin) {
+        const char *salto = static_cast<const char *>(memchr(linea, '\n', trozo->fin - linea));
+        const char *finLinea = salto == nullptr ? trozo->fin : salto;
+        const string_view texto(linea, finLinea - linea);
+        trozo->lineas++;
+        if (not texto.empty() and texto != "\r") {
+            trozo->noVacias++;
+            string_view nombre;
+            float nota;
+            if (interpretarLineaAlumno(texto, nombre, nota)) {
+                trozo->alumnos.push_back({nombre, nota});
+            } else {
+                trozo->invalidas.push_back(trozo->lineas);
+            }
+        }
+        linea = finLinea + 1;
+    }
+}
+
+
+/**
+ * Carga en una lista los alumnos de un fichero CSV (una línea nombre,nota
+ * por alumno) usando todos los núcleos: el fichero se proyecta en memoria,
+ * se divide en trozos que empiezan y acaban en un salto de línea, cada
+ * trozo se interpreta y valida en su propio hilo y al final los alumnos de
+ * todos los trozos se añaden a la lista en el orden del fichero
+ * Las líneas no válidas se cuentan y se saltan; los alumnos que no caben
+ * en la lista se descartan, igual que los repetidos si se pide
+ * @param lista Puntero a una estructura de tipo ListaAlumnos
+ * @param ruta Ruta del fichero CSV
+ * @param resultado Salida con el resumen de la carga
+ * @param sinDuplicados Verdadero para descartar los alumnos cuyo nombre
+ * ya está en la lista (o antes en el fichero)
+ * @return Verdadero si se ha podido leer el fichero
+ */
+bool cargarCSVParalelo(ListaAlumnos *lista, const string &ruta, ResultadoCarga &resultado,
+                       const bool sinDuplicados = false) {
+    const auto inicio = chrono::steady_clock::now();
+    resultado = ResultadoCarga{};
+    FicheroMapeado *fichero = mapearFichero(ruta);
+    if (fichero == nullptr) return false;
+
+    const size_t TAM_MIN_TROZO = 1 << 20;
+    const size_t numHilos = getNumHilosPool();
+    const size_t numTrozos = max<size_t>(1, min(numHilos * 4, fichero->tam / TAM_MIN_TROZO));
+    vector<TrozoCarga> trozos(numTrozos);
+    const char *fin = fichero->datos + fichero->tam;
+    const char *desde = fichero->datos;
+    for (size_t t = 0; t < numTrozos; t++) {
+        const char *hasta = t + 1 == numTrozos ? fin : fichero->datos + fichero->tam / numTrozos * (t + 1);
+        if (hasta < desde) hasta = desde;
+        const char *salto = hasta == fin ? nullptr : static_cast<const char *>(memchr(hasta, '\n', fin - hasta));
+        hasta = salto == nullptr ? fin : salto + 1;
+        trozos[t].inicio = desde;
+        trozos[t].fin = hasta;
+        desde = hasta;
+    }
+    paraCada(0, static_cast<int64_t>(numTrozos), 1, [&trozos](const int64_t desde, const int64_t hasta) {
+        for (int64_t t = desde; t < hasta; t++) interpretarTrozo(&trozos[t]);
+    });
+
+    int64_t lineasAnteriores = 0;
+    for (TrozoCarga &trozo: trozos) {
+        resultado.lineas += trozo.noVacias;
+        resultado.invalidos += static_cast<int64_t>(trozo.invalidas.size());
+        for (const int64_t linea: trozo.invalidas) {
+            if (resultado.lineasInvalidas.size() < MAX_LINEAS_INVALIDAS) {
+                resultado.lineasInvalidas.push_back(lineasAnteriores + linea);
+            }
+        }
+        lineasAnteriores += trozo.lineas;
+        for (const RegistroAlumno &alumno: trozo.alumnos) {
+            if (sinDuplicados and buscarAlumno(lista, alumno.nombre) != -1) {
+                resultado.duplicados++;
+            } else if (estaLlena(lista)) {
+                resultado.sinHueco++;
+            } else if (addAlumno(lista, alumno.nombre, alumno.nota)) {
+                resultado.cargados++;
+            } else {
+                resultado.sinDiario++;
+            }
+        }
+    }
+    desmapearFichero(fichero);
+    resultado.segundos = chrono::duration<double>(chrono::steady_clock::now() - inicio).count();
+    return true;
+}
+
+
+/**
+ * Lector de ficheros por bloques con un hilo que lee por adelantado: hay
+ * varios buffers en anillo y, mientras el programa interpreta el bloque
+ * de uno de ellos, el hilo va llenando los siguientes. Así la lectura del
+ * disco y la interpretación se solapan y la carga va a la velocidad de la
+ * más lenta de las dos en vez de a la suma de ambas
+ */
+struct LectorAsincrono {
+    int fd;
+    vector<vector<char>> buffers;
+    vector<size_t> tamanos; // Bytes válidos de cada buffer
+    mutex cerrojo;
+    condition_variable aviso;
+    size_t llenos; // Buffers leídos pendientes o en uso por el programa
+    size_t siguienteLleno; // Buffer que leerá el hilo a continuación
+    size_t siguienteLeido; // Buffer que entregará siguienteBloque
+    bool enUso; // El programa tiene un bloque entregado
+    bool finFichero;
+    bool error;
+    bool terminar;
+    thread hilo;
+};
+
+
+/**
+ * Función del hilo del lector asíncrono: llena los buffers libres con los
+ * siguientes bloques del fichero hasta llegar al final
+ * @param lector Puntero a una estructura de tipo LectorAsincrono
+ */
+void leerPorAdelantado(LectorAsincrono *lector) {
+    unique_lock<mutex> bloqueo(lector->cerrojo);
+    while (true) {
+        lector->aviso.wait(bloqueo, [lector] { return lector->terminar or lector->llenos < lector->buffers.size(); });
+        if (lector->terminar) return;
+        const size_t b = lector->siguienteLleno;
+        bloqueo.unlock();
+        vector<char> &buffer = lector->buffers[b];
+        size_t tam = 0;
+        int64_t leidos = 1;
+        while (tam < buffer.size() and (leidos = leerFichero(lector->fd, buffer.data() + tam, buffer.size() - tam)) > 0) {
+            tam += leidos;
+        }
+        bloqueo.lock();
+        if (tam > 0) {
+            lector->tamanos[b] = tam;
+            lector->siguienteLleno = (b + 1) % lector->buffers.size();
+            lector->llenos++;
+        }
+        if (leidos <= 0) {
+            lector->finFichero = true;
+            lector->error = leidos < 0;
+        }
+        lector->aviso.notify_all();
+        if (lector->finFichero) return;
+    }
+}
+
+
+/**
+ * Abre un fichero y arranca el hilo que lo lee por adelantado
+ * @param ruta Ruta del fichero
+ * @param numBuffers Número de buffers del anillo (al menos 2)
+ * @param tamBloque Tamaño de cada buffer en bytes
+ * @return Puntero al lector o nulo si no se puede abrir el fichero
+ */
+LectorAsincrono *abrirLectorAsincrono(const string &ruta, const size_t numBuffers = 4,
+                                      const size_t tamBloque = 1 << 20) {
+    const int fd = abrirParaLeer(ruta);
+    if (fd < 0) return nullptr;
+    LectorAsincrono *lector = new LectorAsincrono;
+    lector->fd = fd;
+    lector->buffers.assign(max<size_t>(2, numBuffers), vector<char>(tamBloque));
+    lector->tamanos.assign(lector->buffers.size(), 0);
+    lector->llenos = 0;
+    lector->siguienteLleno = 0;
+    lector->siguienteLeido = 0;
+    lector->enUso = false;
+    lector->finFichero = false;
+    lector->error = false;
+    lector->terminar = false;
+    lector->hilo = thread(leerPorAdelantado, lector);
+    return lector;
+}
+
+
+/**
+ * Entrega el siguiente bloque leído del fichero, esperando a que el hilo
+ * lo tenga si todavía no está. El bloque entregado en la llamada anterior
+ * se devuelve al hilo para que lo vuelva a llenar, por lo que deja de ser válido
+ * @param lector Puntero a una estructura de tipo LectorAsincrono
+ * @param datos Salida con el inicio del bloque
+ * @param tam Salida con el tamaño del bloque
+ * @return Verdadero si hay bloque, falso al final del fichero
+ */
+bool siguienteBloque(LectorAsincrono *lector, const char *&datos, size_t &tam) {
+    unique_lock<mutex> bloqueo(lector->cerrojo);
+    if (lector->enUso) {
+        lector->enUso = false;
+        lector->siguienteLeido = (lector->siguienteLeido + 1) % lector->buffers.size();
+        lector->llenos--;
+        lector->aviso.notify_all();
+    }
+    lector->aviso.wait(bloqueo, [lector] { return lector->llenos > 0 or lector->finFichero; });
+    if (lector->llenos == 0) return false;
+    lector->enUso = true;
+    datos = lector->buffers[lector->siguienteLeido].data();
+    tam = lector->tamanos[lector->siguienteLeido];
+    return true;
+}
+
+
+/**
+ * Detiene el hilo del lector, cierra el fichero y libera la memoria
+ * @param lector Puntero a una estructura de tipo LectorAsincrono
+ * @return Verdadero si no ha habido errores de lectura
+ */
+bool cerrarLectorAsincrono(LectorAsincrono *lector) {
+    {
+        lock_guard<mutex> bloqueo(lector->cerrojo);
+        lector->terminar = true;
+    }
+    lector->aviso.notify_all();
+    lector->hilo.join();
+    cerrarFichero(lector->fd);
+    const bool correcto = not lector->error;
+    delete lector;
+    return correcto;
+}
+
+
+/**
+ * Carga en una lista los alumnos de un fichero CSV (una línea nombre,nota
+ * por alumno) leyéndolo por bloques con un LectorAsincrono, de modo que
+ * mientras se interpretan las líneas de un bloque ya se está leyendo el
+ * siguiente. Sirve para ficheros que no se pueden proyectar en memoria,
+ * como tuberías o dispositivos. Las líneas que quedan partidas entre dos
+ * bloques se unen antes de interpretarlas
+ * Las líneas no válidas se cuentan y se saltan; los alumnos que no caben
+ * en la lista se descartan, igual que los repetidos si se pide
+ * @param lista Puntero a una estructura de tipo ListaAlumnos
+ * @param ruta Ruta del fichero CSV
+ * @param resultado Salida con el resumen de la carga
+ * @param sinDuplicados Verdadero para descartar los alumnos cuyo nombre
+ * ya está en la lista (o antes en el fichero)
+ * @return Verdadero si se ha podido leer el fichero entero
+ */
+bool cargarCSVAsincrono(ListaAlumnos *lista, const string &ruta, ResultadoCarga &resultado,
+                        const bool sinDuplicados = false) {
+    const auto inicio = chrono::steady_clock::now();
+    resultado = ResultadoCarga{};
+    LectorAsincrono *lector = abrirLectorAsincrono(ruta);
+    if (lector == nullptr) return false;
+
+    int64_t numLinea = 0;
+    auto interpretar = [&](const string_view linea) {
+        numLinea++;
+        if (linea.empty() or linea == "\r") return;
+        resultado.lineas++;
+        string_view nombre;
+        float nota;
+        if (not interpretarLineaAlumno(linea, nombre, nota)) {
+            resultado.invalidos++;
+            if (resultado.lineasInvalidas.size() < MAX_LINEAS_INVALIDAS) resultado.lineasInvalidas.push_back(numLinea);
+            return;
+        }
+        if (sinDuplicados and buscarAlumno(lista, nombre) != -1) {
+            resultado.duplicados++;
+            return;
+        }
+        if (estaLlena(lista)) {
+            resultado.sinHueco++;
+            return;
+        }
+        if (addAlumno(lista, nombre, nota)) {
+            resultado.cargados++;
+        } else {
+            resultado.sinDiario++;
+        }
+    };
+    string partida; // Principio de una línea que continúa en el bloque siguiente
+    const char *datos;
+    size_t tam;
+    while (siguienteBloque(lector, datos, tam)) {
+        const char *fin = datos + tam;
+        const char *linea = datos;
+        for (const char *salto; (salto = static_cast<const char *>(memchr(linea, '\n', fin - linea))) != nullptr;
+             linea = salto + 1) {
+            if (partida.empty()) {
+                interpretar(string_view(linea, salto - linea));
+            } else {
+                partida.append(linea, salto - linea);
+                interpretar(partida);
+                partida.clear();
+            }
+        }
+        partida.append(linea, fin - linea);
+    }
+    if (not partida.empty()) interpretar(partida);
+    const bool correcto = cerrarLectorAsincrono(lector);
+    resultado.segundos = chrono::duration<double>(chrono::steady_clock::now() - inicio).count();
+    return correcto;
+}
+
+
+/**
+ * Valor que entrega un generador cuando todavía no tiene listo el
+ * siguiente y obtenerlo lo bloquearía (el teclado mientras nadie escribe):
+ * quien lo consume puede atender a otros generadores y volver a pedírselo
+ * El campo descriptor es el fichero del que el generador espera datos, para
+ * que quien lo consume pueda dormir hasta que los haya
+ */
+struct SinDatos {
+    int descriptor;
+};
+
+
+/**
+ * Generador basado en corrutinas de C++20: una función que hace co_yield
+ * de valores de tipo T y que se ejecuta solo cuando se le pide el
+ * siguiente valor. Entre valor y valor la corrutina queda suspendida, así
+ * que muchas fuentes lentas y rápidas se pueden combinar en el mismo hilo
+ * El valor entregado es una referencia a un objeto de la corrutina y solo
+ * es válido hasta la siguiente llamada a siguiente()
+ * Un generador que puede hacer co_yield de SinDatos solo debe consumirse
+ * comprobando hayValor() después de cada siguiente()
+ */
+template<typename T>
+struct Generador {
+    struct promise_type {
+        const T *actual = nullptr;
+        int espera = -1;
+
+        Generador get_return_object() { return Generador{coroutine_handle<promise_type>::from_promise(*this)}; }
+        suspend_always initial_suspend() noexcept { return {}; }
+        suspend_always final_suspend() noexcept { return {}; }
+
+        suspend_always yield_value(const T &valor) noexcept {
+            actual = addressof(valor);
+            return {};
+        }
+
+        suspend_always yield_value(const SinDatos sinDatos) noexcept {
+            actual = nullptr;
+            espera = sinDatos.descriptor;
+            return {};
+        }
+
+        void return_void() {
+        }
+
+        void unhandled_exception() { terminate(); }
+    };
+
+    coroutine_handle<promise_type> corrutina;
+
+    explicit Generador(const coroutine_handle<promise_type> corrutina) : corrutina(corrutina) {
+    }
+
+    Generador(Generador &&otro) noexcept : corrutina(exchange(otro.corrutina, nullptr)) {
+    }
+
+    Generador &operator=(Generador &&otro) noexcept {
+        if (this != &otro) {
+            if (corrutina) corrutina.destroy();
+            corrutina = exchange(otro.corrutina, nullptr);
+        }
+        return *this;
+    }
+
+    ~Generador() {
+        if (corrutina) corrutina.destroy();
+    }
+
+    /**
+     * Reanuda la corrutina hasta que entrega el siguiente valor o termina
+     * @return Verdadero si hay un valor nuevo
+     */
+    bool siguiente() {
+        if (not corrutina or corrutina.done()) return false;
+        corrutina.resume();
+        return not corrutina.done();
+    }
+
+    /**
+     * @return Verdadero si la última llamada a siguiente() ha entregado un
+     * valor y falso si el generador no tenía datos listos
+     */
+    bool hayValor() const { return corrutina.promise().actual != nullptr; }
+
+    const T &valor() const { return *corrutina.promise().actual; }
+
+    /**
+     * @return Descriptor del que espera datos el generador si la última
+     * llamada a siguiente() no ha entregado un valor
+     */
+    int getEspera() const { return corrutina.promise().espera; }
+};
+
+
+// Descriptor de la entrada estándar, del que lee cin
+const int DESCRIPTOR_TECLADO = 0;
+
+
+/**
+ * Comprueba sin esperar si hay entrada de teclado lista para leer: texto
+ * que stdin ya ha leído y cin aún no ha consumido, o datos (o el final de
+ * la entrada) en el descriptor. Un terminal solo entrega líneas completas
+ * En Windows siempre devuelve verdadero y la lectura espera al usuario
+ * @return Verdadero si leer una línea no detendrá al programa
+ */
+bool hayEntradaTeclado() {
+#ifdef _WIN32
+    return true;
+#else
+#ifdef __GLIBC__
+    if (stdin->_IO_read_ptr < stdin->_IO_read_end) return true;
+#endif
+    pollfd entrada{DESCRIPTOR_TECLADO, POLLIN, 0};
+    return poll(&entrada, 1, 0) > 0;
+#endif
+}
+
+
+/**
+ * Fuente de alumnos que los pide por teclado con las mismas reglas que
+ * inputNombre e inputNota. No usa hilos: tras cada pregunta, mientras el
+ * usuario no ha escrito la respuesta la fuente entrega SinDatos, así que
+ * si la carga termina antes (la lista se ha llenado) no queda ninguna
+ * lectura pendiente ni se pierde lo que se escriba después
+ * @param cuantos Número de alumnos a pedir
+ */
+Generador<RegistroAlumno> fuenteTeclado(const int cuantos) {
+    string nombre, texto;
+    float nota;
+    for (int i = 0; i < cuantos; i++) {
+        cout << "Introduce datos del alumno...\n";
+        do {
+            cout << "Introduce un nombre para el alumno:" << flush;
+            while (not hayEntradaTeclado()) co_yield SinDatos{DESCRIPTOR_TECLADO};
+            if (not getline(cin, nombre)) co_return;
+            if (not esNombreValido(nombre)) {
+                cout << "El nombre no puede quedar vacio!!!\n";
+            }
+        } while (not esNombreValido(nombre));
+        do {
+            cout << "Introduce una nota numerica de 0 a 10:" << flush;
+            while (not hayEntradaTeclado()) co_yield SinDatos{DESCRIPTOR_TECLADO};
+            if (not getline(cin, texto)) co_return;
+        } while (not interpretarNota(texto, nota));
+        co_yield RegistroAlumno{nombre, nota};
+    }
+}
+
+
+// Tamaño de los bloques que lee fuenteFichero
+const size_t TAM_BLOQUE_FUENTE = 1 << 16;
+
+
+/**
+ * Fuente de alumnos que lee un fichero CSV (nombre,nota) por bloques en el
+ * mismo hilo que la consume. El fichero se lee sin espera: si es una
+ * tubería todavía vacía, la fuente entrega SinDatos en lugar de detener a
+ * las demás. Las líneas no válidas se saltan. Los nombres entregados
+ * apuntan directamente al bloque leído, sin copiarlos
+ * @param ruta Ruta del fichero CSV
+ */
+Generador<RegistroAlumno> fuenteFichero(const string ruta) {
+    const int fd = abrirParaLeer(ruta);
+    if (fd < 0) co_return;
+    // Cierra el fichero también si se destruye el generador antes de acabarlo
+    struct CierreFichero {
+        int fd;
+        ~CierreFichero() { cerrarFichero(fd); }
+    } cierre{fd};
+#ifndef _WIN32
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+#endif
+    vector<char> bloque(TAM_BLOQUE_FUENTE);
+    string partida;
+    RegistroAlumno registro;
+    while (true) {
+        const int64_t tam = leerFichero(fd, bloque.data(), bloque.size());
+        if (tam < 0 and (errno == EAGAIN or errno == EWOULDBLOCK)) {
+            co_yield SinDatos{fd};
+            continue;
+        }
+        if (tam <= 0) break;
+        const char *fin = bloque.data() + tam;
+        const char *linea = bloque.data();
+        for (const char *salto; (salto = static_cast<const char *>(memchr(linea, '\n', fin - linea))) != nullptr;
+             linea = salto + 1) {
+            if (partida.empty()) {
+                if (interpretarLineaAlumno(string_view(linea, salto - linea), registro.nombre, registro.nota)) {
+                    co_yield registro;
+                }
+            } else {
+                partida.append(linea, salto - linea);
+                if (interpretarLineaAlumno(partida, registro.nombre, registro.nota)) co_yield registro;
+                partida.clear();
+            }
+        }
+        partida.append(linea, fin - linea);
+    }
+    if (interpretarLineaAlumno(partida, registro.nombre, registro.nota)) co_yield registro;
+}
+
+
+/**
+ * Mide cuánto cuesta crear una lista, cargar en ella un número de alumnos
+ * y destruirla con cada recurso de memoria: new/delete, bloques por
+ * tamaño, monotónico y monotónico sobre un buffer ya reservado (el caso de
+ * un equipo con la memoria fija). Los nombres, de más de 15 caracteres
+ * para que no quepan dentro del string, se preparan antes de medir y cada
+ * medida es la mejor de tres
+ * @param numAlumnos Número de alumnos de la carga
+ */
+void medirRecursosMemoria(const int numAlumnos) {
+    mt19937_64 aleatorio(42);
+    uniform_int_distribution<int> decimas(0, 100);
+    vector<string> nombres(numAlumnos);
+    vector<float> notas(numAlumnos);
+    for (int i = 0; i < numAlumnos; i++) {
+        nombres[i] = "Alumno " + to_string(i + 1) + " Apellido Apellido";
+        notas[i] = static_cast<float>(decimas(aleatorio)) / 10.0f;
+    }
+    const auto cargar = [&](pmr::memory_resource *recurso) {
+        ListaAlumnos *lista = crearLista(numAlumnos, recurso);
+        for (int i = 0; i < numAlumnos; i++) addAlumno(lista, nombres[i], notas[i]);
+        destruirLista(lista);
+    };
+    // Si el buffer se queda corto, el recurso sigue pidiendo memoria al heap
+    vector<byte> buffer(static_cast<size_t>(numAlumnos) * 256);
+    const char *nombresRecursos[] = {"new/delete", "bloques", "monotonico", "buffer fijo"};
+    double segundos[4];
+    for (int r = 0; r < 4; r++) {
+        segundos[r] = INFINITY;
+        for (int repeticion = 0; repeticion < 3; repeticion++) {
+            const auto inicio = chrono::steady_clock::now();
+            if (r == 0) {
+                cargar(pmr::new_delete_resource());
+            } else if (r == 1) {
+                pmr::unsynchronized_pool_resource recurso;
+                cargar(&recurso);
+            } else if (r == 2) {
+                pmr::monotonic_buffer_resource recurso;
+                cargar(&recurso);
+            } else {
+                pmr::monotonic_buffer_resource recurso(buffer.data(), buffer.size());
+                cargar(&recurso);
+            }
+            segundos[r] = min(segundos[r], chrono::duration<double>(chrono::steady_clock::now() - inicio).count());
+        }
+    }
+    cout << "Carga de " << numAlumnos << " alumnos (crear lista, añadir y destruir):" << endl;
+    for (int r = 0; r < 4; r++) {
+        cout << nombresRecursos[r] << ":\t" << segundos[r] * 1000 << " ms\t" << segundos[0] / segundos[r]
+                << "x frente a new/delete" << endl;
+    }
+}
+
+
+// Espera entre dos rondas de intercalarFuentes sin datos donde no se puede usar poll
+const chrono::milliseconds ESPERA_FUENTES(1);
+
+
+/**
+ * Detiene el hilo hasta que alguno de los descriptores tiene datos para
+ * leer o ha llegado a su final, sin gastar procesador mientras tanto
+ * En Windows, donde la consola no se puede esperar así, duerme ESPERA_FUENTES
+ * @param descriptores Descriptores a esperar
+ */
+void esperarDescriptores(const vector<int> &descriptores) {
+#ifdef _WIN32
+    this_thread::sleep_for(ESPERA_FUENTES);
+#else
+    if (descriptores.empty()) {
+        this_thread::sleep_for(ESPERA_FUENTES);
+        return;
+    }
+    vector<pollfd> esperas;
+    for (const int fd : descriptores) esperas.push_back({fd, POLLIN, 0});
+    while (poll(esperas.data(), esperas.size(), -1) < 0 and errno == EINTR) {
+    }
+#endif
+}
+
+
+/**
+ * Combina varias fuentes en una sola tomando un alumno de cada una por
+ * turnos hasta agotarlas todas. Una fuente que no tiene listo el
+ * siguiente alumno (el teclado mientras el usuario escribe) entrega
+ * SinDatos y se salta en esa ronda, así que no detiene a las demás; si
+ * ninguna tiene datos, el hilo duerme hasta que llegan datos a alguna
+ * @param fuentes Fuentes a combinar
+ */
+Generador<RegistroAlumno> intercalarFuentes(vector<Generador<RegistroAlumno>> fuentes) {
+    size_t activas = fuentes.size();
+    vector<bool> agotada(fuentes.size(), false);
+    vector<int> esperas;
+    while (activas > 0) {
+        bool entregado = false;
+        esperas.clear();
+        for (size_t f = 0; f < fuentes.size(); f++) {
+            if (agotada[f]) continue;
+            if (not fuentes[f].siguiente()) {
+                agotada[f] = true;
+                activas--;
+            } else if (fuentes[f].hayValor()) {
+                entregado = true;
+                co_yield fuentes[f].valor();
+            } else {
+                esperas.push_back(fuentes[f].getEspera());
+            }
+        }
+        if (not entregado and activas > 0) esperarDescriptores(esperas);
+    }
+}
+
+
+/**
+ * Lote de alumnos copiados de una fuente. Los nombres van seguidos en un
+ * único string y el lote se reutiliza de un lote al siguiente, de modo
+ * que, una vez alcanzado su tamaño, no se reserva memoria por alumno
+ */
+struct LoteAlumnos {
+    string nombres;
+    vector<uint32_t> finNombres; // Posición en nombres donde acaba cada nombre
+    vector<float> notas;
+};
+
+
+/**
+ * Agrupa los alumnos de una fuente en lotes de tamaño fijo. Como la
+ * fuente solo avanza cuando se pide el siguiente lote, nunca se lee más
+ * de lo que el consumidor va a procesar (contrapresión)
+ * @param fuente Fuente de alumnos
+ * @param tamLote Máximo de alumnos por lote
+ * @param maximo Máximo total de alumnos a tomar de la fuente
+ */
+Generador<LoteAlumnos> agruparEnLotes(Generador<RegistroAlumno> fuente, const size_t tamLote, int64_t maximo) {
+    LoteAlumnos lote;
+    while (maximo > 0) {
+        lote.nombres.clear();
+        lote.finNombres.clear();
+        lote.notas.clear();
+        while (lote.notas.size() < tamLote and maximo > 0 and fuente.siguiente()) {
+            lote.nombres += fuente.valor().nombre;
+            lote.finNombres.push_back(static_cast<uint32_t>(lote.nombres.size()));
+            lote.notas.push_back(fuente.valor().nota);
+            maximo--;
+        }
+        if (lote.notas.empty()) co_return;
+        co_yield lote;
+        if (lote.notas.size() < tamLote and maximo > 0) co_return; // La fuente se ha agotado
+    }
+}
+
+
+/**
+ * Añade a una lista los alumnos de una fuente pasándolos por lotes. Solo
+ * se piden a la fuente los alumnos que caben en la lista
+ * @param fuente Fuente de alumnos
+ * @param lista Puntero a una estructura de tipo ListaAlumnos
+ * @param tamLote Alumnos por lote
+ * @return Número de alumnos añadidos
+ */
+int64_t cargarDesdeFuente(Generador<RegistroAlumno> fuente, ListaAlumnos *lista, const size_t tamLote = 4096) {
+    int64_t cargados = 0;
+    Generador<LoteAlumnos> lotes = agruparEnLotes(std::move(fuente), tamLote, lista->capacidad - lista->num);
+    while (lotes.siguiente()) {
+        const LoteAlumnos &lote = lotes.valor();
+        uint32_t inicio = 0;
+        for (size_t i = 0; i < lote.notas.size(); i++) {
+            const string_view nombre = string_view(lote.nombres).substr(inicio, lote.finNombres[i] - inicio);
+            if (addAlumno(lista, nombre, lote.notas[i])) cargados++;
+            inicio = lote.finNombres[i];
+        }
+    }
+    return cargados;
+}
+
+
+/**
+ * Distribuciones de las notas de los alumnos sintéticos
+ */
+enum DistribucionNotas {
+    NOTAS_UNIFORME, // Uniforme entre 0 y 10
+    NOTAS_NORMAL, // Normal de media 6 y desviación 1,8
+    NOTAS_BIMODAL, // Mitad alrededor de 3 y mitad alrededor de 7,5
+    NOTAS_APROBADOS, // Uniforme entre 5 y 10
+    NOTAS_SUSPENSOS // Uniforme entre 0 y 4,9
+};
+
+
+/**
+ * Parámetros del generador de alumnos sintéticos
+ * Los nombres son "Alumno <n>", para que no se repitan, completados con
+ * letras y espacios hasta una longitud uniforme entre longitudMinima y
+ * longitudMaxima; un nombre nunca es más corto que su "Alumno <n>"
+ */
+struct ConfigGenerador {
+    int64_t cuantos; // Número de alumnos a generar
+    uint64_t semilla; // Semilla: la misma semilla da los mismos alumnos
+    DistribucionNotas notas;
+    int longitudMinima;
+    int longitudMaxima;
+};
+
+// Alumnos de cada bloque del generador; cada bloque tiene su propia
+// secuencia aleatoria, así que el resultado no depende del número de hilos
+const int64_t TAM_BLOQUE_GENERADOR = 1 << 16;
+
+
+/**
+ * Obtiene la distribución de notas que corresponde a un nombre
+ * @param texto Nombre: uniforme, normal, bimodal, aprobados o suspensos
+ * @param distribucion Salida con la distribución
+ * @return Verdadero si el nombre es una distribución conocida
+ */
+bool interpretarDistribucion(const string_view texto, DistribucionNotas &distribucion) {
+    const string_view nombres[] = {"uniforme", "normal", "bimodal", "aprobados", "suspensos"};
+    for (int d = 0; d < 5; d++) {
+        if (texto == nombres[d]) {
+            distribucion = static_cast<DistribucionNotas>(d);
+            return true;
+        }
+    }
+    return false;
+}
+
+
+/**
+ * Genera una nota aleatoria, con un decimal, de una distribución
+ * @param distribucion Distribución de las notas
+ * @param aleatorio Generador de números aleatorios
+ * @return Nota entre 0 y 10
+ */
+float generarNota(const DistribucionNotas distribucion, mt19937_64 &aleatorio) {
+    double nota;
+    switch (distribucion) {
+        case NOTAS_NORMAL: nota = normal_distribution(6.0, 1.8)(aleatorio);
+            break;
+        case NOTAS_BIMODAL: nota = normal_distribution(aleatorio() & 1 ? 7.5 : 3.0, 1.2)(aleatorio);
+            break;
+        case NOTAS_APROBADOS: return static_cast<float>(uniform_int_distribution(50, 100)(aleatorio)) / 10.0f;
+        case NOTAS_SUSPENSOS: return static_cast<float>(uniform_int_distribution(0, 49)(aleatorio)) / 10.0f;
+        default: return static_cast<float>(uniform_int_distribution(0, 100)(aleatorio)) / 10.0f;
+    }
+    return static_cast<float>(round(clamp(nota, 0.0, 10.0) * 10)) / 10.0f;
+}
+
+
+/**
+ * Genera en un lote los alumnos sintéticos de un bloque
+ * Las letras de relleno se sacan de 5 en 5 bits de cada número aleatorio
+ * @param config Referencia constante a los parámetros del generador
+ * @param bloque Número del bloque
+ * @param lote Referencia al lote, que se vacía antes
+ */
+void generarLoteSintetico(const ConfigGenerador &config, const int64_t bloque, LoteAlumnos &lote) {
+    static const char letras[] = "abcdefghijklmnopqrstuvwxyz aeiou"; // 32 caracteres
+    mt19937_64 aleatorio(config.semilla ^ static_cast<uint64_t>(bloque + 1) * 0x9E3779B97F4A7C15);
+    uniform_int_distribution<int> longitud(config.longitudMinima, config.longitudMaxima);
+    const int64_t desde = bloque * TAM_BLOQUE_GENERADOR;
+    const int64_t hasta = min(config.cuantos, desde + TAM_BLOQUE_GENERADOR);
+    lote.nombres.clear();
+    lote.finNombres.clear();
+    lote.notas.clear();
+    char numero[24];
+    for (int64_t i = desde; i < hasta; i++) {
+        const size_t inicio = lote.nombres.size();
+        lote.nombres += "Alumno ";
+        lote.nombres.append(numero, to_chars(numero, numero + sizeof(numero), i + 1).ptr);
+        const size_t objetivo = inicio + longitud(aleatorio);
+        if (lote.nombres.size() < objetivo) {
+            lote.nombres += ' ';
+            uint64_t bits = 0;
+            for (int quedan = 0; lote.nombres.size() < objetivo; quedan--, bits >>= 5) {
+                if (quedan == 0) {
+                    bits = aleatorio();
+                    quedan = 12;
+                }
+                lote.nombres += letras[bits & 31];
+            }
+            if (lote.nombres.back() == ' ') lote.nombres.back() = 'a';
+        }
+        lote.finNombres.push_back(static_cast<uint32_t>(lote.nombres.size()));
+        lote.notas.push_back(generarNota(config.notas, aleatorio));
+    }
+}
+
+
+/**
+ * Genera los alumnos sintéticos por bloques en el pool de hilos y pasa
+ * los lotes, en orden, a una función que los consume en el hilo que llama
+ * Los bloques se generan por tandas, así que la memoria usada no depende
+ * del número de alumnos
+ * @param config Referencia constante a los parámetros del generador
+ * @param consumir Función que recibe cada lote; si devuelve falso la
+ * generación termina
+ * @return Verdadero si se han consumido todos los lotes
+ */
+bool generarSinteticos(const ConfigGenerador &config, const function<bool(const LoteAlumnos &)> &consumir) {
+    const int64_t numBloques = (config.cuantos + TAM_BLOQUE_GENERADOR - 1) / TAM_BLOQUE_GENERADOR;
+    const int64_t porTanda = 4 * static_cast<int64_t>(getNumHilosPool());
+    vector<LoteAlumnos> lotes(porTanda);
+    for (int64_t primero = 0; primero < numBloques; primero += porTanda) {
+        const int64_t enTanda = min(porTanda, numBloques - primero);
+        paraCada(0, enTanda, 1, [&](const int64_t desde, const int64_t hasta) {
+            for (int64_t b = desde; b < hasta; b++) generarLoteSintetico(config, primero + b, lotes[b]);
+        });
+        for (int64_t b = 0; b < enTanda; b++) {
+            if (not consumir(lotes[b])) return false;
+        }
+    }
+    return true;
+}
+
+
+/**
+ * Fuente de alumnos inventados con el generador de alumnos sintéticos,
+ * bloque a bloque en el hilo que los pide: entrega los mismos alumnos que
+ * generarSinteticos con los mismos parámetros
+ * @param config Parámetros del generador
+ */
+Generador<RegistroAlumno> fuenteSintetica(const ConfigGenerador config) {
+    LoteAlumnos lote;
+    const int64_t numBloques = (config.cuantos + TAM_BLOQUE_GENERADOR - 1) / TAM_BLOQUE_GENERADOR;
+    for (int64_t bloque = 0; bloque < numBloques; bloque++) {
+        generarLoteSintetico(config, bloque, lote);
+        uint32_t inicio = 0;
+        for (size_t i = 0; i < lote.notas.size(); i++) {
+            co_yield RegistroAlumno{string_view(lote.nombres).substr(inicio, lote.finNombres[i] - inicio),
+                                    lote.notas[i]};
+            inicio = lote.finNombres[i];
+        }
+    }
+}
+
+
+/**
+ * Añade a una lista alumnos sintéticos hasta el número pedido o hasta
+ * que se llene
+ * @param config Referencia constante a los parámetros del generador
+ * @param lista Puntero a una estructura de tipo ListaAlumnos
+ * @return Número de alumnos añadidos
+ */
+int64_t generarEnLista(const ConfigGenerador &config, ListaAlumnos *lista) {
+    ConfigGenerador ajustada = config;
+    ajustada.cuantos = min<int64_t>(config.cuantos, lista->capacidad - lista->num);
+    int64_t cargados = 0;
+    generarSinteticos(ajustada, [&](const LoteAlumnos &lote) {
+        uint32_t inicio = 0;
+        for (size_t i = 0; i < lote.notas.size(); i++) {
+            const string_view nombre = string_view(lote.nombres).substr(inicio, lote.finNombres[i] - inicio);
+            if (not addAlumno(lista, nombre, lote.notas[i])) return false;
+            cargados++;
+            inicio = lote.finNombres[i];
+        }
+        return true;
+    });
+    return cargados;
+}
+
+
+/**
+ * Escribe alumnos sintéticos en un fichero CSV (nombre,nota) sin pasar
+ * por una lista, de modo que el número de alumnos no está limitado por la
+ * memoria
+ * @param config Referencia constante a los parámetros del generador
+ * @param ruta Ruta del fichero a crear
+ * @return Verdadero si el fichero se ha escrito completo
+ */
+bool generarCSV(const ConfigGenerador &config, const string &ruta) {
+    ofstream fichero(ruta, ios::binary | ios::trunc);
+    if (not fichero) return false;
+    string texto;
+    return generarSinteticos(config, [&](const LoteAlumnos &lote) {
+        texto.clear();
+        uint32_t inicio = 0;
+        char nota[16];
+        for (size_t i = 0; i < lote.notas.size(); i++) {
+            texto.append(lote.nombres, inicio, lote.finNombres[i] - inicio);
+            texto += ',';
+            texto.append(nota, to_chars(nota, nota + sizeof(nota), lote.notas[i]).ptr);
+            texto += '\n';
+            inicio = lote.finNombres[i];
+        }
+        return static_cast<bool>(fichero.write(texto.data(), static_cast<streamsize>(texto.size())));
+    });
+}
+
+
+/**
+ * Escribe alumnos sintéticos en un fichero de tabla de alumnos de tamaño
+ * fijo (el formato de guardarTablaFija) sin montar la tabla en memoria:
+ * los registros se escriben lote a lote según se generan y, como la
+ * generación es reproducible, una segunda pasada escribe detrás los
+ * nombres desbordados. La cabecera se completa al final
+ * @param config Referencia constante a los parámetros del generador
+ * @param ruta Ruta del fichero a crear
+ * @return Verdadero si el fichero se ha escrito completo
+ */
+bool generarTablaFija(const ConfigGenerador &config, const string &ruta) {
+    ofstream fichero(ruta, ios::binary | ios::trunc);
+    if (not fichero) return false;
+    string cabecera = crearCabeceraTablaFija(config.cuantos, 0);
+    fichero.write(cabecera.data(), static_cast<streamsize>(cabecera.size()));
+    vector<AlumnoFijo> registros;
+    uint64_t bytesDesbordados = 0;
+    bool correcto = generarSinteticos(config, [&](const LoteAlumnos &lote) {
+        registros.resize(lote.notas.size());
+        uint32_t inicio = 0;
+        for (size_t i = 0; i < lote.notas.size(); i++) {
+            const string_view nombre = string_view(lote.nombres).substr(inicio, lote.finNombres[i] - inicio);
+            rellenarAlumnoFijo(registros[i], nombre, lote.notas[i], static_cast<uint32_t>(bytesDesbordados));
+            if (nombre.size() > MAX_NOMBRE_FIJO) bytesDesbordados += nombre.size();
+            inicio = lote.finNombres[i];
+        }
+        fichero.write(reinterpret_cast<const char *>(registros.data()),
+                      static_cast<streamsize>(registros.size() * sizeof(AlumnoFijo)));
+        return bytesDesbordados <= UINT32_MAX and fichero;
+    });
+    if (correcto and bytesDesbordados > 0) {
+        string desbordados;
+        correcto = generarSinteticos(config, [&](const LoteAlumnos &lote) {
+            desbordados.clear();
+            uint32_t inicio = 0;
+            for (const uint32_t fin: lote.finNombres) {
+                if (fin - inicio > MAX_NOMBRE_FIJO) desbordados.append(lote.nombres, inicio, fin - inicio);
+                inicio = fin;
+            }
+            return static_cast<bool>(fichero.write(desbordados.data(), static_cast<streamsize>(desbordados.size())));
+        });
+    }
+    cabecera = crearCabeceraTablaFija(config.cuantos, bytesDesbordados);
+    fichero.seekp(0);
+    fichero.write(cabecera.data(), static_cast<streamsize>(cabecera.size()));
+    return correcto and static_cast<bool>(fichero);
+}
+
+
+/**
+ * Genera alumnos sintéticos en un fichero con el formato que indica su
+ * extensión: .afij tabla de registros de tamaño fijo, .plst lista paginada
+ * y cualquier otra CSV. La lista paginada se monta antes en memoria, así
+ * que admite como mucho INT_MAX alumnos
+ * @param config Referencia constante a los parámetros del generador
+ * @param ruta Ruta del fichero a crear
+ * @return Verdadero si el fichero se ha escrito completo
+ */
+bool generarFichero(const ConfigGenerador &config, const string &ruta) {
+    const string extension = filesystem::path(ruta).extension().string();
+    if (extension == ".afij") return generarTablaFija(config, ruta);
+    if (extension != ".plst") return generarCSV(config, ruta);
+    if (config.cuantos > INT_MAX) return false;
+    pmr::monotonic_buffer_resource recurso; // La lista solo vive hasta guardarla
+    ListaAlumnos *lista = crearLista(static_cast<int>(config.cuantos), &recurso);
+    generarEnLista(config, lista);
+    const bool guardada = guardarListaPaginada(lista, ruta);
+    destruirLista(lista);
+    return guardada;
+}
+
+
+/**
+ * Escritura de un fichero por tandas con escrituras vectoriales (writev):
+ * el texto generado se acumula en buffer y los datos que ya están en
+ * memoria, como los nombres de los alumnos, se escriben desde su sitio
+ * sin copiarlos. Cada trozo es texto del buffer (datos nulo, a partir de
+ * la posición desde) o memoria de fuera (datos)
+ */
+struct TrozoSalida {
+    const char *datos;
+    size_t desde;
+    size_t longitud;
+};
+
+struct SalidaVectorial {
+    int fd;
+    string buffer;
+    vector<TrozoSalida> trozos;
+    vector<iovec> vectores;
+    uint64_t bytes; // Bytes escritos en el fichero
+};
+
+// Alumnos por tanda de exportación: el buffer de una tanda cabe en la caché
+const int ALUMNOS_TANDA_EXPORTACION = 512;
+
+
+/**
+ * Añade a la salida un texto copiándolo al buffer; si el trozo anterior
+ * también es del buffer se alarga en lugar de crear otro
+ * @param salida Referencia a la salida
+ * @param texto Texto a añadir
+ */
+void addTexto(SalidaVectorial &salida, const string_view texto) {
+    if (salida.trozos.empty() or salida.trozos.back().datos != nullptr) {
+        salida.trozos.push_back({nullptr, salida.buffer.size(), 0});
+    }
+    salida.buffer += texto;
+    salida.trozos.back().longitud += texto.size();
+}
+
+
+/**
+ * Añade a la salida memoria que sigue viva hasta el siguiente volcado,
+ * sin copiarla
+ * @param salida Referencia a la salida
+ * @param datos Memoria a escribir
+ */
+void addReferencia(SalidaVectorial &salida, const string_view datos) {
+    if (not datos.empty()) salida.trozos.push_back({datos.data(), 0, datos.size()});
+}
+
+
+/**
+ * Escribe en el fichero todo lo añadido a la salida y la vacía
+ * @param salida Referencia a la salida
+ * @return Verdadero si se ha escrito todo
+ */
+bool volcarSalida(SalidaVectorial &salida) {
+    salida.vectores.clear();
+    for (const TrozoSalida &trozo: salida.trozos) {
+        const char *datos = trozo.datos != nullptr ? trozo.datos : salida.buffer.data() + trozo.desde;
+        salida.vectores.push_back({const_cast<char *>(datos), trozo.longitud});
+        salida.bytes += trozo.longitud;
+    }
+    const bool escrito = escribirVectores(salida.fd, salida.vectores.data(), salida.vectores.size());
+    salida.buffer.clear();
+    salida.trozos.clear();
+    return escrito;
+}
+
+
+/**
+ * Añade a la salida un texto entre comillas con el escapado de JSON; si
+ * no hay nada que escapar, el texto se escribe desde su sitio
+ * @param salida Referencia a la salida
+ * @param texto Texto a añadir
+ */
+void addCadenaJSON(SalidaVectorial &salida, const string_view texto) {
+    addTexto(salida, "\"");
+    const auto especial = [](const char c) { return c == '"' or c == '\\' or static_cast<unsigned char>(c) < 0x20; };
+    if (none_of(texto.begin(), texto.end(), especial)) {
+        addReferencia(salida, texto);
+    } else {
+        string escapado;
+        for (const char c: texto) {
+            if (not especial(c)) {
+                escapado += c;
+            } else if (c == '"' or c == '\\') {
+                (escapado += '\\') += c;
+            } else {
+                char codigo[8];
+                snprintf(codigo, sizeof(codigo), "\\u%04x", static_cast<unsigned char>(c));
+                escapado += codigo;
+            }
+        }
+        addTexto(salida, escapado);
+    }
+    addTexto(salida, "\"");
+}
+
+
+/**
+ * Añade a la salida un número con el texto más corto que vuelve a dar el
+ * mismo valor
+ * @param salida Referencia a la salida
+ * @param valor Número a añadir
+ */
+template<typename T>
+void addNumero(SalidaVectorial &salida, const T valor) {
+    char texto[32];
+    addTexto(salida, string_view(texto, to_chars(texto, texto + sizeof(texto), valor).ptr - texto));
+}
+
+
+/**
+ * Resumen de una lista que se exporta junto con sus alumnos
+ */
+struct InformeExportado {
+    int64_t alumnos;
+    float media;
+    float maxima; // -1 si la lista está vacía
+    int64_t suspensos;
+    vector<float> percentiles; // De FRACCIONES_EXPORTADAS
+};
+
+const double FRACCIONES_EXPORTADAS[] = {0.25, 0.5, 0.75, 0.9};
+const char *const NOMBRES_FRACCIONES_EXPORTADAS[] = {"p25", "p50", "p75", "p90"};
+
+
+/**
+ * Calcula el resumen que se exporta de una lista con sus consultas de siempre
+ * @param lista Puntero a una estructura constante de tipo ListaAlumnos
+ * @return El resumen
+ */
+InformeExportado getInformeExportado(const ListaAlumnos *lista) {
+    const Alumno *max = getAlumnoMaxNota(lista);
+    return InformeExportado{
+        lista->num, getNotaMedia(lista), max != nullptr ? max->nota : -1.0f,
+        contarAlumnos(lista, FILTRO_SUSPENSOS),
+        getPercentiles(lista->sketchNotas, vector<double>(begin(FRACCIONES_EXPORTADAS), end(FRACCIONES_EXPORTADAS)))
+    };
+}
+
+
+/**
+ * Exporta un curso en JSON lines: una primera línea con el informe del
+ * curso y una línea por alumno, en el orden de la lista
+ * {"tipo":"informe","curso":...,"alumnos":n,"media":x,"maxima":x o null,"suspensos":n,"p25":x,...}
+ * {"tipo":"alumno","nombre":...,"nota":x}
+ * @param curso Puntero a una estructura constante de tipo Curso
+ * @param fd Descriptor del fichero, abierto para escribir
+ * @return Bytes escritos o -1 si ha fallado la escritura
+ */
+int64_t exportarJSON(const Curso *curso, const int fd) {
+    const ListaAlumnos *lista = curso->lista;
+    const InformeExportado informe = getInformeExportado(lista);
+    SalidaVectorial salida{fd, {}, {}, {}, 0};
+    addTexto(salida, "{\"tipo\":\"informe\",\"curso\":");
+    addCadenaJSON(salida, curso->nombre);
+    addTexto(salida, ",\"alumnos\":");
+    addNumero(salida, informe.alumnos);
+    addTexto(salida, ",\"media\":");
+    addNumero(salida, informe.media);
+    addTexto(salida, ",\"maxima\":");
+    if (informe.alumnos == 0) addTexto(salida, "null");
+    else addNumero(salida, informe.maxima);
+    addTexto(salida, ",\"suspensos\":");
+    addNumero(salida, informe.suspensos);
+    for (size_t p = 0; p < informe.percentiles.size(); p++) {
+        addTexto(salida, ",\"");
+        addTexto(salida, NOMBRES_FRACCIONES_EXPORTADAS[p]);
+        addTexto(salida, "\":");
+        if (informe.alumnos == 0) addTexto(salida, "null");
+        else addNumero(salida, informe.percentiles[p]);
+    }
+    addTexto(salida, "}\n");
+    for (int i = 0; i < lista->num; i++) {
+        addTexto(salida, "{\"tipo\":\"alumno\",\"nombre\":");
+        addCadenaJSON(salida, lista->alumnos[i].nombre);
+        addTexto(salida, ",\"nota\":");
+        addNumero(salida, lista->alumnos[i].nota);
+        addTexto(salida, "}\n");
+        if ((i + 1) % ALUMNOS_TANDA_EXPORTACION == 0 and not volcarSalida(salida)) return -1;
+    }
+    if (not volcarSalida(salida)) return -1;
+    return static_cast<int64_t>(salida.bytes);
+}
+
+
+// Formato binario de exportación: [magico u32][version u32] y tramas
+// [tipo u8][longitud u32][datos], con los números en el orden de bytes
+// de la máquina, como los demás ficheros binarios de la aplicación
+const uint32_t MAGICO_EXPORTACION = 0x50584541; // "AEXP"
+const uint32_t VERSION_EXPORTACION = 1;
+const uint8_t TRAMA_INFORME = 1; // [alumnos u64][media f32][maxima f32][suspensos u64][p25..p90 f32][curso]
+const uint8_t TRAMA_ALUMNO = 2; // [nota f32][nombre]
+
+
+/**
+ * Exporta un curso en el formato binario de tramas: la trama del informe
+ * y una trama por alumno, en el orden de la lista
+ * @param curso Puntero a una estructura constante de tipo Curso
+ * @param fd Descriptor del fichero, abierto para escribir
+ * @return Bytes escritos o -1 si ha fallado la escritura
+ */
+int64_t exportarBinario(const Curso *curso, const int fd) {
+    const ListaAlumnos *lista = curso->lista;
+    const InformeExportado informe = getInformeExportado(lista);
+    SalidaVectorial salida{fd, {}, {}, {}, 0};
+    string cabecera;
+    escribirBinario<uint32_t>(cabecera, MAGICO_EXPORTACION);
+    escribirBinario<uint32_t>(cabecera, VERSION_EXPORTACION);
+    escribirBinario<uint8_t>(cabecera, TRAMA_INFORME);
+    escribirBinario<uint32_t>(cabecera, static_cast<uint32_t>(2 * sizeof(uint64_t) + 2 * sizeof(float) +
+                                                              informe.percentiles.size() * sizeof(float) +
+                                                              curso->nombre.size()));
+    escribirBinario<uint64_t>(cabecera, informe.alumnos);
+    escribirBinario<float>(cabecera, informe.media);
+    escribirBinario<float>(cabecera, informe.maxima);
+    escribirBinario<uint64_t>(cabecera, informe.suspensos);
+    for (const float percentil: informe.percentiles) escribirBinario<float>(cabecera, percentil);
+    addTexto(salida, cabecera);
+    addReferencia(salida, curso->nombre);
+    char trama[sizeof(uint8_t) + sizeof(uint32_t) + sizeof(float)];
+    for (int i = 0; i < lista->num; i++) {
+        const Alumno *alumno = &lista->alumnos[i];
+        const uint32_t longitud = static_cast<uint32_t>(sizeof(float) + alumno->nombre.size());
+        trama[0] = static_cast<char>(TRAMA_ALUMNO);
+        memcpy(trama + 1, &longitud, sizeof(longitud));
+        memcpy(trama + 1 + sizeof(longitud), &alumno->nota, sizeof(float));
+        addTexto(salida, string_view(trama, sizeof(trama)));
+        addReferencia(salida, alumno->nombre);
+        if ((i + 1) % ALUMNOS_TANDA_EXPORTACION == 0 and not volcarSalida(salida)) return -1;
+    }
+    if (not volcarSalida(salida)) return -1;
+    return static_cast<int64_t>(salida.bytes);
+}
+
+
+/**
+ * Exporta un curso a un fichero en JSON lines si la ruta acaba en .jsonl
+ * o en el formato binario de tramas en otro caso
+ * @param curso Puntero a una estructura constante de tipo Curso
+ * @param ruta Ruta del fichero a crear
+ * @return Bytes escritos o -1 si no se ha podido escribir el fichero
+ */
+int64_t exportarCurso(const Curso *curso, const string &ruta) {
+    const int fd = abrirParaEscribir(ruta);
+    if (fd < 0) return -1;
+    const bool json = filesystem::path(ruta).extension() == ".jsonl";
+    const int64_t bytes = json ? exportarJSON(curso, fd) : exportarBinario(curso, fd);
+    cerrarFichero(fd);
+    return bytes;
+}
+
+
+/**
+ * Criterios para ordenar listados de alumnos
+ */
+enum CriterioOrden {
+    ORDEN_NOTA_ASCENDENTE, // De menor a mayor nota
+    ORDEN_NOTA_DESCENDENTE, // De mayor a menor nota
+    ORDEN_NOMBRE // Por nombre
+};
+
+
+/**
+ * Registro de un alumno durante la ordenación externa. A igual nota se
+ * ordena por nombre y la posición original del alumno desempata para que
+ * la ordenación sea estable
+ */
+struct RegistroOrden {
+    float nota;
+    uint64_t posicion;
+    string nombre;
+};
+
+
+/**
+ * Compara dos registros según el criterio de ordenación
+ * @return Verdadero si a debe ir antes que b
+ */
+bool precede(const RegistroOrden &a, const RegistroOrden &b, const CriterioOrden criterio) {
+    if (criterio == ORDEN_NOTA_DESCENDENTE and a.nota != b.nota) return a.nota > b.nota;
+    if (criterio == ORDEN_NOTA_ASCENDENTE and a.nota != b.nota) return a.nota < b.nota;
+    if (a.nombre != b.nombre) return a.nombre < b.nombre;
+    return a.posicion < b.posicion;
+}
+
+
+/**
+ * Ordena las notas de una lista por radix sort (LSD, 3 pasadas de 11
+ * bits) sobre la representación binaria del float, con el bit de signo
+ * invertido (y todos los bits en los negativos) para que el orden de los
+ * bits como entero sin signo coincida con el orden numérico, también con
+ * -0, que queda junto a 0. Se ordenan pares
+ * (clave, posición), sin mover ni copiar los alumnos, y como cada pasada
+ * es estable los alumnos con la misma nota conservan el orden de la lista
+ * @param lista Puntero a una estructura constante de tipo ListaAlumnos
+ * @param descendente Verdadero para ordenar de mayor a menor nota
+ * @return Posiciones de los alumnos en el orden pedido
+ */
+vector<int> ordenarPorNota(const ListaAlumnos *lista, const bool descendente) {
+    const int n = lista->num;
+    vector<uint64_t> claves(n), auxiliar(n); // Clave en los 32 bits altos, posición en los bajos
+    for (int i = 0; i < n; i++) {
+        uint32_t bits;
+        memcpy(&bits, &lista->alumnos[i].nota, sizeof(float));
+        bits ^= bits >> 31 ? 0xFFFFFFFF : 0x80000000; // Los bits de un float ordenan como el float
+        if (descendente) bits = ~bits;
+        claves[i] = static_cast<uint64_t>(bits) << 32 | static_cast<uint32_t>(i);
+    }
+    const int BITS_DIGITO = 11;
+    const uint64_t MASCARA = (1 << BITS_DIGITO) - 1;
+    for (int desplazamiento = 32; desplazamiento < 64; desplazamiento += BITS_DIGITO) {
+        size_t cuenta[(1 << BITS_DIGITO) + 1] = {};
+        for (const uint64_t clave: claves) cuenta[(clave >> desplazamiento & MASCARA) + 1]++;
+        for (int d = 0; d < 1 << BITS_DIGITO; d++) cuenta[d + 1] += cuenta[d];
+        for (const uint64_t clave: claves) auxiliar[cuenta[clave >> desplazamiento & MASCARA]++] = clave;
+        claves.swap(auxiliar);
+    }
+    vector<int> orden(n);
+    for (int i = 0; i < n; i++) orden[i] = static_cast<int>(claves[i] & 0xFFFFFFFF);
+    return orden;
+}
+
+
+/**
+ * Clave de ordenación por nombre: 8 bytes del nombre como entero
+ * big-endian, que se comparan de una vez sin acceder al alumno, y la
+ * posición del alumno en la lista
+ */
+struct ClaveNombre {
+    uint64_t prefijo;
+    int posicion;
+};
+
+
+/**
+ * Compara dos claves de nombre por prefijo y, a igual prefijo, por posición
+ */
+inline bool menorClave(const ClaveNombre &a, const ClaveNombre &b) {
+    return a.prefijo != b.prefijo ? a.prefijo < b.prefijo : a.posicion < b.posicion;
+}
+
+
+/**
+ * Ordena un tramo de claves de nombre por prefijo con radix sort (LSD, 4
+ * pasadas de 16 bits). Las pasadas en las que todas las claves tienen el
+ * mismo dígito, como ocurre con los bytes que comparten todos los nombres,
+ * se saltan. Al ser estable, a igual prefijo se mantiene el orden de
+ * entrada, que debe estar por posición
+ * Los tramos pequeños se ordenan por comparación
+ * @param claves Primera clave del tramo
+ * @param n Número de claves del tramo
+ */
+void ordenarPorPrefijo(ClaveNombre *claves, const int n) {
+    if (n < 1024) {
+        sort(claves, claves + n, menorClave);
+        return;
+    }
+    const int BITS_DIGITO = 16;
+    const uint64_t MASCARA = (1 << BITS_DIGITO) - 1;
+    vector<ClaveNombre> auxiliar(n);
+    vector<size_t> cuenta((1 << BITS_DIGITO) + 1);
+    for (int desplazamiento = 0; desplazamiento < 64; desplazamiento += BITS_DIGITO) {
+        fill(cuenta.begin(), cuenta.end(), 0);
+        for (int i = 0; i < n; i++) cuenta[(claves[i].prefijo >> desplazamiento & MASCARA) + 1]++;
+        if (cuenta[(claves[0].prefijo >> desplazamiento & MASCARA) + 1] == static_cast<size_t>(n)) continue;
+        for (int d = 0; d < 1 << BITS_DIGITO; d++) cuenta[d + 1] += cuenta[d];
+        for (int i = 0; i < n; i++) auxiliar[cuenta[claves[i].prefijo >> desplazamiento & MASCARA]++] = claves[i];
+        copy(auxiliar.begin(), auxiliar.end(), claves);
+    }
+}
+
+
+/**
+ * @param nombre Nombre del alumno
+ * @param desde Posición del primer byte del prefijo
+ * @return Los 8 bytes del nombre a partir de desde como entero big-endian,
+ * completados con ceros si el nombre se acaba antes
+ */
+uint64_t getPrefijoNombre(const string_view nombre, const size_t desde) {
+    uint64_t prefijo = 0;
+    for (size_t b = desde; b < desde + 8; b++) {
+        prefijo = prefijo << 8 | (b < nombre.size() ? static_cast<uint8_t>(nombre[b]) : 0);
+    }
+    return prefijo;
+}
+
+
+/**
+ * Deshace los empates de un tramo de claves ya ordenado por prefijo: cada
+ * grupo de claves con el mismo prefijo se vuelve a ordenar con los 8
+ * bytes siguientes de los nombres, y así hasta que los nombres se acaban
+ * Solo se accede a los alumnos de los grupos empatados, una vez por nivel
+ * @param lista Puntero a una estructura constante de tipo ListaAlumnos
+ * @param claves Primera clave del tramo
+ * @param n Número de claves del tramo
+ * @param desde Posición en los nombres del prefijo por el que está ordenado
+ */
+void deshacerEmpatesNombre(const ListaAlumnos *lista, ClaveNombre *claves, const int n, const size_t desde) {
+    for (int i = 0, j; i < n; i = j) {
+        for (j = i + 1; j < n and claves[j].prefijo == claves[i].prefijo; j++) {
+        }
+        if (j - i == 1) continue;
+        bool quedanBytes = false;
+        for (int k = i; k < j; k++) {
+            const pmr::string &nombre = lista->alumnos[claves[k].posicion].nombre;
+            quedanBytes = quedanBytes or nombre.size() > desde + 8;
+            claves[k].prefijo = getPrefijoNombre(nombre, desde + 8);
+        }
+        if (not quedanBytes) continue; // Nombres iguales: ya están por posición
+        ordenarPorPrefijo(claves + i, j - i);
+        deshacerEmpatesNombre(lista, claves + i, j - i, desde + 8);
+    }
+}
+
+
+/**
+ * Ordena una lista por nombre sin copiar los alumnos: ordena por radix
+ * un "array" de claves ClaveNombre con los 8 primeros bytes de cada nombre y después
+ * deshace los empates con los bytes siguientes. El "array" se divide en
+ * bloques que se ordenan en paralelo y después se mezclan de dos en dos,
+ * también en paralelo
+ * A igual nombre se conserva el orden de la lista
+ * @param lista Puntero a una estructura constante de tipo ListaAlumnos
+ * @return Posiciones de los alumnos ordenadas por nombre
+ */
+vector<int> ordenarPorNombre(const ListaAlumnos *lista) {
+    const int n = lista->num;
+    vector<ClaveNombre> claves(n);
+    const int numBloques = n < 100000 ? 1 : static_cast<int>(bit_floor(static_cast<unsigned>(getNumHilosPool())));
+    vector<int> limites(numBloques + 1);
+    for (int b = 0; b <= numBloques; b++) limites[b] = static_cast<int>(static_cast<int64_t>(n) * b / numBloques);
+    paraCada(0, numBloques, 1, [&](const int64_t desde, const int64_t hasta) {
+        for (int64_t b = desde; b < hasta; b++) {
+            for (int i = limites[b]; i < limites[b + 1]; i++) {
+                claves[i] = {getPrefijoNombre(lista->alumnos[i].nombre, 0), i};
+            }
+            ordenarPorPrefijo(claves.data() + limites[b], limites[b + 1] - limites[b]);
+        }
+    });
+    vector<ClaveNombre> auxiliar(numBloques > 1 ? n : 0);
+    for (int ancho = 1; ancho < numBloques; ancho *= 2) {
+        paraCada(0, numBloques / (2 * ancho), 1, [&](const int64_t desde, const int64_t hasta) {
+            for (int64_t par = desde; par < hasta; par++) {
+                const int64_t b = par * 2 * ancho;
+                const auto inicio = claves.begin() + limites[b], mitad = claves.begin() + limites[b + ancho];
+                const auto fin = claves.begin() + limites[b + 2 * ancho];
+                merge(inicio, mitad, mitad, fin, auxiliar.begin() + limites[b], menorClave);
+            }
+        });
+        claves.swap(auxiliar);
+    }
+    // Los empates se deshacen por bloques que no parten ningún grupo de prefijos iguales
+    for (int b = 1; b < numBloques; b++) {
+        limites[b] = max(limites[b], limites[b - 1]);
+        while (limites[b] > limites[b - 1] and limites[b] < n and
+               claves[limites[b]].prefijo == claves[limites[b] - 1].prefijo) {
+            limites[b]++;
+        }
+    }
+    paraCada(0, numBloques, 1, [&](const int64_t desde, const int64_t hasta) {
+        for (int64_t b = desde; b < hasta; b++) {
+            deshacerEmpatesNombre(lista, claves.data() + limites[b], limites[b + 1] - limites[b], 0);
+        }
+    });
+    vector<int> orden(n);
+    for (int i = 0; i < n; i++) orden[i] = claves[i].posicion;
+    return orden;
+}
+
+
+/**
+ * Obtiene el orden de los alumnos de una lista según un criterio, como
+ * posiciones en la lista, sin mover los alumnos
+ * @param lista Puntero a una estructura constante de tipo ListaAlumnos
+ * @param criterio Criterio de ordenación
+ * @return Posiciones de los alumnos en el orden pedido
+ */
+vector<int> ordenarLista(const ListaAlumnos *lista, const CriterioOrden criterio) {
+    if (estaVacia(lista)) return {};
+    if (criterio == ORDEN_NOMBRE) return ordenarPorNombre(lista);
+    return ordenarPorNota(lista, criterio == ORDEN_NOTA_DESCENDENTE);
+}
+
+
+/**
+ * Devuelve las posiciones de los alumnos de una lista que pasan un filtro,
+ * en el orden de la lista o en el de un criterio, guardadas en la cache de
+ * la lista o, si no están al día, recalculadas y guardadas en ella
+ * @param lista Puntero a una estructura constante de tipo ListaAlumnos
+ * @param filtro Alumnos que forman parte del listado
+ * @param ordenada false para seguir el orden de la lista
+ * @param criterio Criterio de ordenación si ordenada es true
+ * @return Referencia constante a las posiciones, válida hasta el siguiente
+ * cambio de la lista
+ */
+const pmr::vector<int> &getPosiciones(const ListaAlumnos *lista, const FiltroLista filtro, const bool ordenada,
+                                      const CriterioOrden criterio) {
+    PosicionesCacheadas &entrada = lista->cache.posiciones[ordenada ? 1 + criterio : 0][filtro];
+    ContadoresCache &contadores = lista->cache.contadores[CONSULTA_POSICIONES];
+    if (entrada.version == lista->version) {
+        contadores.aciertos++;
+        return entrada.posiciones;
+    }
+    contadores.fallos++;
+    if (ordenada) {
+        const vector<int> orden = ordenarLista(lista, criterio);
+        entrada.posiciones.assign(orden.begin(), orden.end());
+    } else {
+        entrada.posiciones.resize(lista->num);
+        for (int i = 0; i < lista->num; i++) entrada.posiciones[i] = i;
+    }
+    if (filtro != FILTRO_TODOS) {
+        const bool aprobados = filtro == FILTRO_APROBADOS;
+        erase_if(entrada.posiciones, [lista, aprobados](const int i) {
+            return (lista->alumnos[i].nota >= 5) != aprobados;
+        });
+    }
+    entrada.version = lista->version;
+    return entrada.posiciones;
+}
+
+
+/**
+ * Estructura para recorrer por páginas los alumnos de una lista en un
+ * orden y con un filtro dados, sin mover los alumnos de la lista
+ * El campo posiciones apunta a las posiciones en la lista de los alumnos
+ * de la vista en el orden del listado, guardadas en la cache de la lista,
+ * de modo que cualquier página se obtiene directamente sin recorrer las
+ * anteriores. Si la vista sigue el orden de la lista y no filtra, el campo
+ * directa es true y posiciones es nulo: la posición i de la vista es la
+ * posición i de la lista
+ * Los campos num y version son el número de alumnos y la versión de la
+ * lista al crear la vista; si la versión ha cambiado, la vista está
+ * obsoleta y hay que volver a crearla
+ */
+struct VistaLista {
+    const ListaAlumnos *lista;
+    bool directa;
+    const pmr::vector<int> *posiciones;
+    int num;
+    uint64_t version;
+};
+
+
+/**
+ * Crea una vista de una lista de alumnos con el filtro indicado y,
+ * si se pide, en el orden de un criterio
+ * Coste O(1) para la vista directa (sin orden ni filtro) y para las que
+ * están en la cache de la lista; si no, O(n) para las filtradas y el de
+ * ordenarLista para las ordenadas
+ * @param lista Puntero a una estructura constante de tipo ListaAlumnos
+ * @param filtro Alumnos que forman parte de la vista
+ * @param ordenada false para seguir el orden de la lista
+ * @param criterio Criterio de ordenación si ordenada es true
+ * @return Puntero a la estructura de tipo VistaLista creada
+ */
+VistaLista *crearVista(const ListaAlumnos *lista, const FiltroLista filtro, const bool ordenada,
+                       const CriterioOrden criterio) {
+    VistaLista *vista = new VistaLista{lista, not ordenada and filtro == FILTRO_TODOS, nullptr, lista->num,
+                                       lista->version};
+    if (not vista->directa) vista->posiciones = &getPosiciones(lista, filtro, ordenada, criterio);
+    return vista;
+}
+
+
+/**
+ * Libera la memoria de una vista; no toca la lista de alumnos ni su cache
+ * @param vista Puntero a una estructura de tipo VistaLista
+ */
+void destruirVista(VistaLista *vista) {
+    delete vista;
+}
+
+
+/**
+ * Comprueba si la lista ha cambiado desde que se creó la vista
+ * @param vista Puntero a una estructura constante de tipo VistaLista
+ * @return true si hay que volver a crear la vista
+ */
+bool estaObsoleta(const VistaLista *vista) {
+    return vista->version != vista->lista->version;
+}
+
+
+/**
+ * Devuelve cuántos alumnos tiene una vista
+ * @param vista Puntero a una estructura constante de tipo VistaLista
+ * @return Número de alumnos de la vista
+ */
+int getNumAlumnos(const VistaLista *vista) {
+    return vista->directa ? vista->num : static_cast<int>(vista->posiciones->size());
+}
+
+
+/**
+ * Devuelve el alumno de una posición de la vista, sin recorrer las anteriores
+ * @param vista Puntero a una estructura constante de tipo VistaLista
+ * @param i Posición del alumno en la vista
+ * @return Puntero al alumno
+ */
+const Alumno *getAlumno(const VistaLista *vista, const int i) {
+    return &vista->lista->alumnos[vista->directa ? i : (*vista->posiciones)[i]];
+}
+
+
+/**
+ * Obtiene una página de una vista: como mucho limite alumnos a partir de
+ * la posición desplazamiento. El coste es proporcional al tamaño de la página
+ * @param vista Puntero a una estructura constante de tipo VistaLista
+ * @param desplazamiento Posición en la vista del primer alumno de la página
+ * @param limite Número máximo de alumnos de la página
+ * @param pagina Vector donde se dejan los alumnos de la página
+ * @return Número de alumnos de la página; 0 si el desplazamiento queda
+ * fuera de la vista o la vista está obsoleta
+ */
+int getPagina(const VistaLista *vista, const int desplazamiento, const int limite, vector<const Alumno *> &pagina) {
+    pagina.clear();
+    if (estaObsoleta(vista) or desplazamiento < 0 or limite <= 0) return 0;
+    const int fin = static_cast<int>(min<int64_t>(getNumAlumnos(vista), static_cast<int64_t>(desplazamiento) + limite));
+    for (int i = desplazamiento; i < fin; i++) pagina.push_back(getAlumno(vista, i));
+    return static_cast<int>(pagina.size());
+}
+
+
+/**
+ * Estructura para recorrer una vista página a página
+ * El campo siguiente es la posición en la vista del primer alumno de la
+ * próxima página
+ */
+struct CursorLista {
+    const VistaLista *vista;
+    int siguiente;
+};
+
+
+/**
+ * Crea un cursor sobre una vista que empieza en la posición indicada
+ * @param vista Puntero a una estructura constante de tipo VistaLista
+ * @param desplazamiento Posición en la vista del primer alumno
+ * @return El cursor
+ */
+CursorLista abrirCursor(const VistaLista *vista, const int desplazamiento) {
+    return CursorLista{vista, max(0, desplazamiento)};
+}
+
+
+/**
+ * Obtiene la siguiente página de un cursor y lo avanza
+ * @param cursor Referencia al cursor
+ * @param limite Número máximo de alumnos de la página
+ * @param pagina Vector donde se dejan los alumnos de la página
+ * @return false si no quedan alumnos o la vista del cursor está obsoleta
+ */
+bool siguientePagina(CursorLista &cursor, const int limite, vector<const Alumno *> &pagina) {
+    cursor.siguiente += getPagina(cursor.vista, cursor.siguiente, limite, pagina);
+    return not pagina.empty();
+}
+
+
+/**
+ * Formatea un alumno en una línea de texto igual a la que escribe
+ * printAlumno y la añade al final de un buffer
+ * @param destino Buffer donde se añade la línea
+ * @param nombre Nombre del alumno
+ * @param nota Nota del alumno
+ */
+void formatearAlumno(string &destino, const string &nombre, const float nota) {
+    char numero[32];
+    const int longitud = snprintf(numero, sizeof(numero), "%g", nota); // Igual que cout con float
+    destino += "Nombre:";
+    destino += nombre;
+    destino += "\tNota:";
+    destino.append(numero, longitud);
+    destino += '\n';
+}
+
+
+/**
+ * Escritor de un flujo de salida en un hilo aparte con doble buffer:
+ * mientras el hilo escribe un buffer, el programa va llenando el otro, de
+ * modo que el cálculo y la escritura se solapan
+ */
+struct EscritorAsincrono {
+    ostream *salida;
+    mutex cerrojo;
+    condition_variable aviso;
+    string lleno; // Buffer entregado que el hilo tiene que escribir
+    bool hayLleno;
+    bool terminar;
+    thread hilo;
+};
+
+
+/**
+ * Función del hilo del escritor asíncrono: escribe cada buffer entregado
+ * @param escritor Puntero a una estructura de tipo EscritorAsincrono
+ */
+void escribirBuffersEntregados(EscritorAsincrono *escritor) {
+    unique_lock<mutex> bloqueo(escritor->cerrojo);
+    while (true) {
+        escritor->aviso.wait(bloqueo, [escritor] { return escritor->hayLleno or escritor->terminar; });
+        if (not escritor->hayLleno) return;
+        bloqueo.unlock();
+        escritor->salida->write(escritor->lleno.data(), static_cast<streamsize>(escritor->lleno.size()));
+        bloqueo.lock();
+        escritor->lleno.clear();
+        escritor->hayLleno = false;
+        escritor->aviso.notify_all();
+    }
+}
+
+
+/**
+ * Crea un escritor asíncrono y arranca su hilo
+ * @param salida Flujo donde se escribirán los buffers
+ * @return Puntero al escritor
+ */
+EscritorAsincrono *crearEscritor(ostream &salida) {
+    EscritorAsincrono *escritor = new EscritorAsincrono;
+    escritor->salida = &salida;
+    escritor->hayLleno = false;
+    escritor->terminar = false;
+    escritor->hilo = thread(escribirBuffersEntregados, escritor);
+    return escritor;
+}
+
+
+/**
+ * Entrega un buffer al escritor, esperando si todavía está escribiendo el
+ * anterior. El buffer se devuelve vacío (es el que el hilo ya escribió)
+ * para que se pueda seguir llenando
+ * @param escritor Puntero a una estructura de tipo EscritorAsincrono
+ * @param buffer Buffer con los datos a escribir
+ */
+void entregarBuffer(EscritorAsincrono *escritor, string &buffer) {
+    unique_lock<mutex> bloqueo(escritor->cerrojo);
+    escritor->aviso.wait(bloqueo, [escritor] { return not escritor->hayLleno; });
+    escritor->lleno.swap(buffer);
+    escritor->hayLleno = true;
+    escritor->aviso.notify_all();
+}
+
+
+/**
+ * Espera a que se haya escrito todo lo entregado, detiene el hilo y
+ * libera el escritor
+ * @param escritor Puntero a una estructura de tipo EscritorAsincrono
+ */
+void cerrarEscritor(EscritorAsincrono *escritor) {
+    {
+        lock_guard<mutex> bloqueo(escritor->cerrojo);
+        escritor->terminar = true;
+    }
+    escritor->aviso.notify_all();
+    escritor->hilo.join();
+    escritor->salida->flush();
+    delete escritor;
+}
+
+
+/**
+ * Lector secuencial de un fichero de tramo de la ordenación externa, con
+ * un buffer grande para leer en bloques
+ * Formato de cada registro: [nota f32][posicion u64][longitud u32][nombre]
+ */
+struct LectorTramo {
+    ifstream fichero;
+    vector<char> buffer;
+    RegistroOrden actual;
+};
+
+
+/**
+ * Lee el siguiente registro de un tramo
+ * @return Verdadero si se ha leído un registro, falso al final del tramo
+ */
+bool leerRegistro(istream &fichero, RegistroOrden &registro) {
+    uint32_t longitud;
+    fichero.read(reinterpret_cast<char *>(&registro.nota), sizeof(float));
+    fichero.read(reinterpret_cast<char *>(&registro.posicion), sizeof(uint64_t));
+    fichero.read(reinterpret_cast<char *>(&longitud), sizeof(uint32_t));
+    if (not fichero) return false;
+    registro.nombre.resize(longitud);
+    fichero.read(registro.nombre.data(), longitud);
+    return static_cast<bool>(fichero);
+}
+
+
+/**
+ * Añade un registro en formato de tramo al final de un buffer
+ */
+void escribirRegistro(string &destino, const RegistroOrden &registro) {
+    escribirBinario<float>(destino, registro.nota);
+    escribirBinario<uint64_t>(destino, registro.posicion);
+    escribirBinario<uint32_t>(destino, registro.nombre.size());
+    destino += registro.nombre;
+}
+
+
+/**
+ * Resumen de una ordenación externa
+ */
+struct EstadisticasOrdenacion {
+    int64_t registros;
+    int tramos; // Tramos ordenados volcados a ficheros temporales
+    int pasadas; // Pasadas de mezcla
+    double segundos;
+};
+
+// Máximo de tramos que se mezclan a la vez; si hay más se hacen varias pasadas
+const int MAX_TRAMOS_MEZCLA = 64;
+
+
+/**
+ * Mezcla k tramos ordenados leyéndolos en bloques grandes y entrega cada
+ * registro en orden a la función destino
+ * @param rutas Rutas de los ficheros de los tramos
+ * @param criterio Criterio de ordenación con el que se ordenaron los tramos
+ * @param memoriaBytes Memoria para los buffers de lectura
+ * @param destino Función que recibe los registros ya mezclados
+ */
+template<typename Destino>
+void mezclarTramos(const vector<string> &rutas, const CriterioOrden criterio, const size_t memoriaBytes,
+                   Destino destino) {
+    const size_t tamBuffer = max<size_t>(64 << 10, memoriaBytes / (rutas.size() + 1));
+    vector<LectorTramo> lectores(rutas.size());
+    auto despues = [&lectores, criterio](const size_t a, const size_t b) {
+        return precede(lectores[b].actual, lectores[a].actual, criterio);
+    };
+    priority_queue<size_t, vector<size_t>, decltype(despues)> siguientes(despues);
+    for (size_t i = 0; i < rutas.size(); i++) {
+        lectores[i].buffer.resize(tamBuffer);
+        lectores[i].fichero.rdbuf()->pubsetbuf(lectores[i].buffer.data(), static_cast<streamsize>(tamBuffer));
+        lectores[i].fichero.open(rutas[i], ios::binary);
+        if (leerRegistro(lectores[i].fichero, lectores[i].actual)) siguientes.push(i);
+    }
+    while (not siguientes.empty()) {
+        const size_t i = siguientes.top();
+        siguientes.pop();
+        destino(lectores[i].actual);
+        if (leerRegistro(lectores[i].fichero, lectores[i].actual)) siguientes.push(i);
+    }
+}
+
+
+/**
+ * Ordena una lista paginada que puede no caber en memoria (ordenación
+ * externa por mezcla) y escribe el resultado con el mismo formato que
+ * printAlumno
+ * 1. Lee los alumnos en orden (notas, índice y nombres a la vez, por
+ * bloques, sin cargar la columna de notas entera) hasta llenar la mitad
+ * de la memoria permitida, contando los nombres y el "array" de
+ * registros, los ordena y los vuelca a un fichero temporal (un tramo);
+ * el volcado se hace en un hilo propio, fuera del pool de hilos de
+ * cálculo, mientras se lee y ordena el siguiente tramo con la otra mitad
+ * de la memoria
+ * 2. Si hay más de MAX_TRAMOS_MEZCLA tramos, los mezcla por grupos en
+ * tramos más largos hasta que quedan pocos
+ * 3. Mezcla los tramos restantes formateando las líneas en un buffer que
+ * escribe otro hilo mientras se prepara el siguiente
+ * @param rutaLista Ruta de la lista paginada a ordenar
+ * @param criterio Criterio de ordenación
+ * @param memoriaBytes Memoria máxima que puede usar la ordenación
+ * @param salida Flujo donde se escribe la lista ordenada
+ * @param estadisticas Salida con el resumen de la ordenación
+ * @return Verdadero si la ordenación se ha completado
+ */
+bool ordenarListaExterna(const string &rutaLista, const CriterioOrden criterio, const size_t memoriaBytes,
+                         ostream &salida, EstadisticasOrdenacion &estadisticas) {
+    const auto inicio = chrono::steady_clock::now();
+    estadisticas = EstadisticasOrdenacion{};
+    ListaPaginada *lista = abrirListaPaginada(rutaLista, false);
+    if (lista == nullptr) return false;
+    ifstream notas(rutaLista, ios::binary), indice(rutaLista, ios::binary), nombres(rutaLista, ios::binary);
+    vector<char> bufferNotas(1 << 20), bufferIndice(1 << 20), bufferNombres(1 << 20);
+    notas.rdbuf()->pubsetbuf(bufferNotas.data(), static_cast<streamsize>(bufferNotas.size()));
+    indice.rdbuf()->pubsetbuf(bufferIndice.data(), static_cast<streamsize>(bufferIndice.size()));
+    nombres.rdbuf()->pubsetbuf(bufferNombres.data(), static_cast<streamsize>(bufferNombres.size()));
+    notas.seekg(static_cast<streamoff>(CABECERA_LISTA_PAGINADA));
+    indice.seekg(static_cast<streamoff>(lista->inicioIndice));
+    nombres.seekg(static_cast<streamoff>(lista->inicioNombres));
+
+    static atomic<int> ordenaciones{0};
+    const filesystem::path directorio = filesystem::temp_directory_path() /
+                                        ("parcial-orden-" + to_string(chrono::steady_clock::now().time_since_epoch().
+                                                                      count()) + "-" + to_string(++ordenaciones));
+    filesystem::create_directories(directorio);
+    vector<string> tramos;
+    int numTramos = 0; // Tramos creados en todas las pasadas: cada uno tiene un nombre distinto
+    auto nuevoTramo = [&directorio, &tramos, &numTramos] {
+        tramos.push_back((directorio / ("tramo-" + to_string(numTramos++))).string());
+        return tramos.back();
+    };
+
+    // 1. Tramos ordenados, volcando cada uno mientras se prepara el siguiente
+    const size_t memoriaTramo = max<size_t>(memoriaBytes / 2, 1 << 20);
+    bool correcto = true;
+    bool volcadoCorrecto = true; // Solo lo escribe el hilo de volcado; se lee después de esperarlo
+    thread volcado; // Volcado en curso: escritura bloqueante que no ocupa un hilo del pool
+    vector<RegistroOrden> registros, volcando;
+    auto volcar = [&volcadoCorrecto](vector<RegistroOrden> &tramo, const string ruta) {
+        ofstream fichero(ruta, ios::binary | ios::trunc);
+        string buffer;
+        for (const RegistroOrden &registro: tramo) {
+            escribirRegistro(buffer, registro);
+            if (buffer.size() >= 1 << 20) {
+                fichero.write(buffer.data(), static_cast<streamsize>(buffer.size()));
+                buffer.clear();
+            }
+        }
+        fichero.write(buffer.data(), static_cast<streamsize>(buffer.size()));
+        if (not fichero) volcadoCorrecto = false;
+        tramo.clear();
+    };
+    uint64_t desde, hasta;
+    indice.read(reinterpret_cast<char *>(&desde), sizeof(uint64_t));
+    size_t bytesNombres = 0; // Memoria de los nombres del tramo; la del "array" es su capacidad
+    for (int64_t i = 0; correcto and i < lista->num; i++) {
+        float nota;
+        notas.read(reinterpret_cast<char *>(&nota), sizeof(float));
+        indice.read(reinterpret_cast<char *>(&hasta), sizeof(uint64_t));
+        if (not notas or not indice or not esNotaValida(nota) or hasta < desde or hasta > lista->bytesNombres) {
+            correcto = false;
+            break;
+        }
+        RegistroOrden registro{nota, static_cast<uint64_t>(i), string(hasta - desde, '\0')};
+        nombres.read(registro.nombre.data(), static_cast<streamsize>(registro.nombre.size()));
+        desde = hasta;
+        bytesNombres += registro.nombre.capacity();
+        registros.push_back(std::move(registro));
+        const size_t memoriaUsada = bytesNombres + registros.capacity() * sizeof(RegistroOrden);
+        if (memoriaUsada >= memoriaTramo or i + 1 == lista->num) {
+            sort(registros.begin(), registros.end(), [criterio](const RegistroOrden &a, const RegistroOrden &b) {
+                return precede(a, b, criterio);
+            });
+            if (volcado.joinable()) volcado.join();
+            if (not volcadoCorrecto) break;
+            volcando.swap(registros);
+            volcado = thread(volcar, ref(volcando), nuevoTramo());
+            bytesNombres = 0;
+        }
+    }
+    if (volcado.joinable()) volcado.join();
+    correcto = correcto and volcadoCorrecto and notas and indice and nombres;
+    estadisticas.registros = lista->num;
+    estadisticas.tramos = static_cast<int>(tramos.size());
+    cerrarListaPaginada(lista);
+
+    // 2. Pasadas intermedias mientras haya demasiados tramos
+    while (correcto and tramos.size() > MAX_TRAMOS_MEZCLA) {
+        vector<string> pendientes;
+        pendientes.swap(tramos);
+        for (size_t i = 0; i < pendientes.size(); i += MAX_TRAMOS_MEZCLA) {
+            const vector<string> grupo(pendientes.begin() + i,
+                                       pendientes.begin() + min(pendientes.size(), i + MAX_TRAMOS_MEZCLA));
+            ofstream fichero(nuevoTramo(), ios::binary | ios::trunc);
+            string buffer;
+            mezclarTramos(grupo, criterio, memoriaBytes, [&](const RegistroOrden &registro) {
+                escribirRegistro(buffer, registro);
+                if (buffer.size() >= 1 << 20) {
+                    fichero.write(buffer.data(), static_cast<streamsize>(buffer.size()));
+                    buffer.clear();
+                }
+            });
+            fichero.write(buffer.data(), static_cast<streamsize>(buffer.size()));
+            correcto = correcto and static_cast<bool>(fichero);
+            for (const string &ruta: grupo) filesystem::remove(ruta);
+        }
+        estadisticas.pasadas++;
+    }
+
+    // 3. Mezcla final con la escritura de la salida solapada
+    if (correcto) {
+        EscritorAsincrono *escritor = crearEscritor(salida);
+        string buffer;
+        mezclarTramos(tramos, criterio, memoriaBytes, [&](const RegistroOrden &registro) {
+            formatearAlumno(buffer, registro.nombre, registro.nota);
+            if (buffer.size() >= 1 << 20) entregarBuffer(escritor, buffer);
+        });
+        entregarBuffer(escritor, buffer);
+        cerrarEscritor(escritor);
+        estadisticas.pasadas++;
+        correcto = static_cast<bool>(salida);
+    }
+    error_code error;
+    filesystem::remove_all(directorio, error);
+    estadisticas.segundos = chrono::duration<double>(chrono::steady_clock::now() - inicio).count();
+    return correcto;
+}
+
+
+/**
+ * Caso de uso de la aplicación elegido por el usuario mediante menu
+ * cuando quiere añadir un nuevo alumno a la lista
+ * El método debe comprobar si la lista proporcionada está llena o no
+ * Si lo está debe mostrar un mensaje de error y terminar
+ * Si no, procede con la llamada a las instrucciones que insertan un nuevo
+ * alumno en la lista
+ * @param lista Referencia a una estructura de tipo ListaAlumnos
+ */
+void addAlumno(ListaAlumnos &lista) {
+    if (estaLlena(&lista)) {
+        std::cout << "Lista llena, no se puede insertar el alumno" << endl;
+        return;
+    }
+    if (not addAlumno(&lista, inputAlumno(lista.recurso))) {
+        cout << "No se puede registrar el alta en el diario, el alumno no se ha insertado" << endl;
+    }
+}
+
+
+/**
+ * Imprime por consola en una línea de texto los datos de nombre y nota del
+ * alumno proporcionado como argumento de llamada
+ * @param alumno Puntero a estructura constante de tipo Alumno que apunta
+ * al alumno que se va a mostrar por la consola
+ */
+void printAlumno(const Alumno *alumno) {
+    MEDIR_OPERACION(OP_PRINT_ALUMNO);
+    if (alumno == nullptr) return;
+    cout << "Nombre:" << alumno->nombre << "\tNota:" << alumno->nota << endl;
+}
+
+
+/**
+ * Caso de uso de la aplicación elegido por el usuario mediante menu
+ * cuando quiere visualizar los datos de la lista
+ * El método debe comprobar si la lista proporcionada está vacía o no
+ * Si está vacía debe mostrar un mensaje indicando que está vacía
+ * Si no, delegando en el método printAlumno recorre e imprime uno tras
+ * otro los alumnos de la lista
+ * @param lista Referencia constante a una estructura de tipo ListaAlumnos
+ */
+void printLista(const ListaAlumnos &lista) {
+    MEDIR_OPERACION(OP_PRINT_LISTA);
+    if (estaVacia(&lista)) {
+        cout << "Lista vacia!!!" << endl;
+        return;
+    }
+    cout << "ALUMNOS:" << endl;
+    for (int i = 0; i < lista.num; i++) {
+        printAlumno(&lista.alumnos[i]);
+    }
+}
+
+
+/**
+ * Pide al usuario un criterio de ordenación de la lista de alumnos
+ * Vuelve a preguntar mientras la opción no sea válida
+ * @return El criterio elegido
+ */
+CriterioOrden inputCriterioOrden() {
+    int criterio;
+    do {
+        cout << "Ordenar por 1) nota ascendente 2) nota descendente 3) nombre:";
+        cin >> criterio;
+    } while (criterio < 1 or criterio > 3);
+    cin.get();
+    return criterio == 1 ? ORDEN_NOTA_ASCENDENTE : criterio == 2 ? ORDEN_NOTA_DESCENDENTE : ORDEN_NOMBRE;
+}
+
+
+/**
+ * Caso de uso de la aplicación elegido por el usuario mediante menu
+ * cuando quiere visualizar los datos de la lista ordenados
+ * Igual que printLista pero recorriendo la lista en el orden que pide
+ * el usuario, que se guarda en la cache de la lista para las siguientes veces
+ * @param lista Referencia constante a una estructura de tipo ListaAlumnos
+ */
+void printListaOrdenada(const ListaAlumnos &lista) {
+    MEDIR_OPERACION(OP_PRINT_LISTA_ORDENADA);
+    if (estaVacia(&lista)) {
+        cout << "Lista vacia!!!" << endl;
+        return;
+    }
+    const pmr::vector<int> &orden = getPosiciones(&lista, FILTRO_TODOS, true, inputCriterioOrden());
+    cout << "ALUMNOS:" << endl;
+    for (const int i: orden) {
+        printAlumno(&lista.alumnos[i]);
+    }
+}
+
+
+/**
+ * Caso de uso de la aplicación elegido por el usuario mediante menu
+ * cuando quiere visualizar la lista por páginas
+ * Pide el orden, el filtro, la posición de inicio y el tamaño de página,
+ * y va imprimiendo páginas mientras el usuario quiera seguir y queden alumnos
+ * @param lista Referencia constante a una estructura de tipo ListaAlumnos
+ */
+void printListaPorPaginas(const ListaAlumnos &lista) {
+    MEDIR_OPERACION(OP_PRINT_LISTA_PAGINAS);
+    if (estaVacia(&lista)) {
+        cout << "Lista vacia!!!" << endl;
+        return;
+    }
+    int orden, filtro, desplazamiento, limite;
+    do {
+        cout << "Orden 0) de la lista 1) nota ascendente 2) nota descendente 3) nombre:";
+        cin >> orden;
+    } while (orden < 0 or orden > 3);
+    do {
+        cout << "Filtro 0) todos 1) aprobados 2) suspensos:";
+        cin >> filtro;
+    } while (filtro < 0 or filtro > 2);
+    do {
+        cout << "Posicion del primer alumno (desde 0):";
+        cin >> desplazamiento;
+    } while (desplazamiento < 0);
+    do {
+        cout << "Alumnos por pagina:";
+        cin >> limite;
+    } while (limite <= 0);
+    cin.get();
+
+    const CriterioOrden criterio = orden == 1 ? ORDEN_NOTA_ASCENDENTE : orden == 2 ? ORDEN_NOTA_DESCENDENTE : ORDEN_NOMBRE;
+    VistaLista *vista = crearVista(&lista, static_cast<FiltroLista>(filtro), orden != 0, criterio);
+    cout << "Alumnos en el listado: " << getNumAlumnos(vista) << endl;
+    CursorLista cursor = abrirCursor(vista, desplazamiento);
+    vector<const Alumno *> pagina;
+    char seguir = 's';
+    while (seguir == 's' and siguientePagina(cursor, limite, pagina)) {
+        cout << "ALUMNOS " << cursor.siguiente - static_cast<int>(pagina.size()) << " a " << cursor.siguiente - 1
+                << ":" << endl;
+        for (const Alumno *alumno: pagina) printAlumno(alumno);
+        if (cursor.siguiente >= getNumAlumnos(vista)) break;
+        cout << "Siguiente pagina (s/n):";
+        cin >> seguir;
+        cin.get();
+    }
+    destruirVista(vista);
+}
+
+
+/**
+ * Caso de uso de la aplicación elegido por el usuario mediante menu
+ * cuando quiere visualizar la nota media de los alumnos
+ * El método debe comprobar si la lista proporcionada está vacía o no
+ * Si está vacía debe mostrar un mensaje indicando que está vacía y
+ * no se va a calcular ninguna nota media
+ * Si no, obtiene la media mediante una llamada al método que devuelve
+ * la nota media de los alumnos de una lista de alumnos definido anteriormente
+ * y la imprime por consola
+ * @param lista Referencia constante a una estructura de tipo ListaAlumnos
+ */
+void printNotaMedia(const ListaAlumnos &lista) {
+    MEDIR_OPERACION(OP_PRINT_NOTA_MEDIA);
+    if (estaVacia(&lista)) {
+        cout << "Lista vacia, no se puede calcular ninguna media!!!" << endl;
+        return;
+    }
+    const float media = getNotaMedia(&lista);
+    cout << "Nota media: " << media << endl;
+}
+
+
+/**
+ * Caso de uso de la aplicación elegido por el usuario mediante menu
+ * cuando quiere visualizar los datos del alumno con mayor nota
+ * El método debe comprobar si la lista proporcionada está vacía o no
+ * Si está vacía debe mostrar un mensaje indicando que está vacía y
+ * no se buscará ningún alumno
+ * Si no, obtiene un puntero al alumno con mejor nota de una lista de alumnos
+ * mediante una llamada al método que busca el alumno con la nota maxima
+ * en una lista y si este puntero no es un puntero nulo imprime los datos
+ * del alumno apoyándose el el método para imprimir los datos de un alumno
+ * @param lista Referencia constante a una estructura de tipo ListaAlumnos
+ */
+void printAlumnoMaxNota(const ListaAlumnos &lista) {
+    MEDIR_OPERACION(OP_PRINT_MAX_NOTA);
+    if (estaVacia(&lista)) {
+        cout << "Lista vacia, no se buscara alumno!!!" << endl;
+        return;
+    }
+    const Alumno *alumno = getAlumnoMaxNota(&lista);
+    if (alumno != nullptr) {
+        printAlumno(alumno);
+    }
+}
+
+
+/**
+ * Caso de uso de la aplicación elegido por el usuario mediante menu
+ * cuando quiere comprobar si existe algún alumno en la lista que no haya
+ * aprobado
+ * El método debe comprobar si la lista proporcionada está vacía o no
+ * Si está vacía debe mostrar un mensaje indicando que está vacía y
+ * no procede buscar
+ * Si no, mediante una llamada al método que comprueba a partir de una lista
+ * de alumnos si existe alguno suspenso o no obtiene el resultado y muestra por
+ * pantalla un texto que diga Si en caso de ser verdadero o No en caso de ser falso
+ * el resultado
+ * @param lista Referencia constante a una estructura de tipo ListaAlumnos
+ */
+void printCheckAlumnoSuspenso(const ListaAlumnos &lista) {
+    MEDIR_OPERACION(OP_PRINT_SUSPENSO);
+    if (estaVacia(&lista)) {
+        cout << "Lista vacia, no procede!!!" << endl;
+        return;
+    }
+    bool alumnoSuspenso = existeAlumnoSuspenso(&lista);
+    cout << "Hay alumnos suspendidos: " << (alumnoSuspenso ? "Si" : "No") << endl;
+}
+
+
+/**
+ * Muestra por consola la mediana y los percentiles 90 y 99 aproximados de
+ * un resumen de notas, con el tiempo que se ha tardado en obtenerlos y la
+ * memoria que ocupa el resumen
+ * @param sketch Referencia constante al resumen
+ * @param percentiles Notas de los percentiles de FRACCIONES_PERCENTILES
+ * @param us Microsegundos que se ha tardado en obtenerlos
+ */
+void printPercentiles(const SketchKLL &sketch, const float *percentiles, const double us) {
+    cout << "Percentiles aproximados de " << sketch.num << " notas: p50 " << percentiles[0] << "\tp90 "
+            << percentiles[1] << "\tp99 " << percentiles[2]
+            << "\t(" << us << " us, resumen de " << getBytesSketch(sketch) << " bytes)" << endl;
+}
+
+
+/**
+ * Muestra por consola la mediana y los percentiles 90 y 99 aproximados de
+ * un resumen de notas, calculándolos
+ * @param sketch Referencia constante al resumen
+ */
+void printPercentiles(const SketchKLL &sketch) {
+    const auto inicio = chrono::steady_clock::now();
+    const vector<float> percentiles = getPercentiles(
+            sketch, vector<double>(begin(FRACCIONES_PERCENTILES), end(FRACCIONES_PERCENTILES)));
+    const double us = chrono::duration<double, micro>(chrono::steady_clock::now() - inicio).count();
+    printPercentiles(sketch, percentiles.data(), us);
+}
+
+
+/**
+ * Caso de uso de la aplicación elegido por el usuario mediante menu
+ * cuando quiere ver los percentiles de las notas de la lista
+ * Los calcula a partir del resumen de notas que mantiene la lista, sin
+ * recorrer los alumnos, y los guarda en la cache de consultas hasta que
+ * la lista cambie
+ * @param lista Referencia constante a una estructura de tipo ListaAlumnos
+ */
+void printPercentiles(const ListaAlumnos &lista) {
+    MEDIR_OPERACION(OP_PRINT_PERCENTILES);
+    if (estaVacia(&lista)) {
+        cout << "Lista vacia!!!" << endl;
+        return;
+    }
+    const auto inicio = chrono::steady_clock::now();
+    const PercentilesCacheados &percentiles = actualizarPercentiles(&lista);
+    const double us = chrono::duration<double, micro>(chrono::steady_clock::now() - inicio).count();
+    printPercentiles(lista.sketchNotas, percentiles.notas, us);
+}
+
+
+/**
+ * Caso de uso de la aplicación elegido por el usuario mediante menu
+ * cuando quiere contar alumnos por franjas de nota
+ * Muestra cuántos alumnos hay en cada franja de un punto, los suspensos
+ * y los de nota 9 o más, y después cuenta los de una franja que pide
+ * al usuario; todo sale del índice de notas de la lista
+ * @param lista Referencia constante a una estructura de tipo ListaAlumnos
+ */
+void printFranjasNotas(const ListaAlumnos &lista) {
+    MEDIR_OPERACION(OP_PRINT_FRANJAS);
+    if (estaVacia(&lista)) {
+        cout << "Lista vacia!!!" << endl;
+        return;
+    }
+    for (int u = 0; u < NUM_UMBRALES_NOTA; u++) {
+        const int hasta = u + 1 == NUM_UMBRALES_NOTA ? NUM_UMBRALES_NOTA + 1 : u + 1; // La última incluye el 10
+        cout << "[" << u << ", " << (hasta > NUM_UMBRALES_NOTA ? "10]" : to_string(hasta) + ")") << ": "
+                << contarAlumnosEntreNotas(&lista, u, hasta) << endl;
+    }
+    const ConjuntoAlumnos suspensos = getAlumnosEntreNotas(&lista, 0, 5);
+    const ConjuntoAlumnos sobresalientes = getAlumnosEntreNotas(&lista, 9, NUM_UMBRALES_NOTA + 1);
+    cout << "Suspensos: " << contarAlumnos(suspensos) << "\tNota 9 o mas: " << contarAlumnos(sobresalientes)
+            << "\tEn alguno de los dos grupos: " << contarAlumnos(unir(suspensos, sobresalientes)) << endl;
+    int desde, hasta;
+    do {
+        cout << "Nota minima de la franja (0 a 10):";
+        cin >> desde;
+    } while (desde < 0 or desde > NUM_UMBRALES_NOTA);
+    do {
+        cout << "Nota a partir de la que no se cuenta (" << desde + 1 << " a 11):";
+        cin >> hasta;
+    } while (hasta <= desde or hasta > NUM_UMBRALES_NOTA + 1);
+    cin.get();
+    cout << "Alumnos con nota en [" << desde << ", " << hasta << "): " << contarAlumnosEntreNotas(&lista, desde, hasta)
+            << endl;
+}
+
+
+/**
+ * Muestra por consola el tamaño y la tasa de falsos positivos del filtro
+ * de Bloom de nombres de una lista
+ * @param lista Referencia constante a una estructura de tipo ListaAlumnos
+ */
+void printFiltroNombres(const ListaAlumnos &lista) {
+    const EstadisticasBloom filtro = getEstadisticasBloom(lista.filtroNombres);
+    cout << "Filtro de nombres: " << filtro.bytes << " bytes, " << filtro.numHashes << " hashes, "
+            << filtro.insertados << " nombres (" << filtro.bitsPorElemento << " bits por nombre, "
+            << 100 * filtro.ocupacion << "% de bits a 1)" << endl;
+    cout << "Falsos positivos: objetivo " << filtro.fprObjetivo << "\testimado " << filtro.fprEstimada
+            << "\tmedido " << filtro.fprMedida << " (" << lista.filtroNombres->consultas << " busquedas, "
+            << lista.filtroNombres->descartes << " descartadas por el filtro)" << endl;
+}
+
+
+/**
+ * Caso de uso de la aplicación elegido por el usuario mediante menu
+ * cuando quiere buscar un alumno por su nombre
+ * Pide el nombre y muestra el primer alumno con ese nombre o un mensaje
+ * si no está en la lista
+ * @param lista Referencia constante a una estructura de tipo ListaAlumnos
+ */
+void buscarAlumno(const ListaAlumnos &lista) {
+    const string nombre = inputNombre();
+    const int posicion = buscarAlumno(&lista, nombre);
+    if (posicion == -1) {
+        cout << "No hay ningun alumno con ese nombre" << endl;
+        return;
+    }
+    cout << "Posicion " << posicion << ", puesto " << getPuestoAlumno(&lista, posicion) << " de " << lista.num
+            << " por nota: ";
+    printAlumno(&lista.alumnos[posicion]);
+}
+
+
+/**
+ * Caso de uso de la aplicación elegido por el usuario mediante menu
+ * cuando quiere ver los alumnos con nota entre dos valores
+ * Pide las notas mínima y máxima (incluidas) y cuántos alumnos mostrar,
+ * y los muestra de menor a mayor nota junto con el total encontrado
+ * @param lista Referencia constante a una estructura de tipo ListaAlumnos
+ */
+void printAlumnosEntreNotas(const ListaAlumnos &lista) {
+    MEDIR_OPERACION(OP_PRINT_ENTRE_NOTAS);
+    if (estaVacia(&lista)) {
+        cout << "Lista vacia!!!" << endl;
+        return;
+    }
+    cout << "Nota minima. ";
+    const float minima = inputNota();
+    cout << "Nota maxima. ";
+    const float maxima = inputNota();
+    int limite;
+    do {
+        cout << "Alumnos a mostrar como maximo:";
+        cin >> limite;
+    } while (limite < 0);
+    cin.get();
+    const int total = contarEntreNotas(&lista, minima, maxima);
+    cout << "Alumnos con nota entre " << minima << " y " << maxima << ": " << total << endl;
+    if (total == 0 or limite == 0) return;
+    for (const int posicion: listarEntreNotas(&lista, minima, maxima, limite)) printAlumno(&lista.alumnos[posicion]);
+}
+
+
+/**
+ * Caso de uso de la aplicación elegido por el usuario mediante menu
+ * cuando quiere ver cuánta memoria ocupa la lista de alumnos
+ * Obtiene las estadísticas de memoria de la lista y las muestra por consola
+ * @param lista Referencia constante a una estructura de tipo ListaAlumnos
+ */
+void printMemoria(const ListaAlumnos &lista) {
+    const EstadisticasMemoria memoria = getEstadisticasMemoria(&lista);
+    cout << "Bytes vivos: " << memoria.bytesVivos << endl;
+    cout << "Reservas de memoria: " << memoria.reservas << endl;
+    cout << "Pico de bytes: " << memoria.picoBytes << endl;
+    cout << "Bytes por alumno: " << memoria.bytesPorAlumno
+            << " (Alumno " << sizeof(Alumno) << " + nombre)" << endl;
+    cout << "Bytes sin usar por la capacidad: " << memoria.bytesDesperdiciados
+            << " (" << lista.capacidad - lista.num << " huecos libres)" << endl;
+    printFiltroNombres(lista);
+}
+
+
+/**
+ * Caso de uso de la aplicación elegido por el usuario mediante menu
+ * cuando quiere ver el uso de la cache de consultas de la lista
+ * Muestra la versión de la lista y, por tipo de consulta, los aciertos,
+ * fallos y parches de la cache
+ * @param lista Referencia constante a una estructura de tipo ListaAlumnos
+ */
+void printCacheConsultas(const ListaAlumnos &lista) {
+    const char *NOMBRES_CONSULTAS[NUM_CONSULTAS_CACHEADAS] = {"Agregados", "Listados", "Percentiles"};
+    cout << "Version de la lista: " << lista.version << "\tRecorridos de notas: " << kernelsNotas->nombre
+            << " (mejor disponible: " << VARIANTES_KERNELS[getMejorVariante()].nombre << ")" << endl;
+    for (int consulta = 0; consulta < NUM_CONSULTAS_CACHEADAS; consulta++) {
+        const ContadoresCache &contadores = lista.cache.contadores[consulta];
+        const uint64_t consultas = contadores.aciertos + contadores.fallos;
+        cout << NOMBRES_CONSULTAS[consulta] << ": aciertos " << contadores.aciertos << "\tfallos " << contadores.fallos
+                << "\tparches " << contadores.parches;
+        if (consultas > 0) cout << "\t(" << 100.0 * static_cast<double>(contadores.aciertos) / consultas << "% aciertos)";
+        cout << endl;
+    }
+}
+
+
+/**
+ * Pide al usuario por su nombre el recurso de memoria de la lista de un curso
+ * Vuelve a preguntar mientras el nombre no sea válido
+ * @return El tipo de recurso elegido
+ */
+TipoRecurso inputTipoRecurso() {
+    string texto;
+    TipoRecurso tipo;
+    do {
+        cout << "Recurso de memoria (general, bloques, monotonico, buffer):";
+        cin >> texto;
+    } while (not interpretarTipoRecurso(texto, tipo));
+    return tipo;
+}
+
+
+/**
+ * Caso de uso de la aplicación elegido por el usuario mediante menu
+ * cuando quiere crear un curso nuevo
+ * Pide el nombre, la capacidad y el recurso de memoria del curso y lo da
+ * de alta en el catálogo mostrando un mensaje de error si ya existe un
+ * curso con ese nombre
+ * @param catalogo Referencia a una estructura de tipo CatalogoCursos
+ */
+void addCurso(CatalogoCursos &catalogo) {
+    const string nombre = inputNombreCurso();
+    if (buscarCurso(&catalogo, nombre) != -1) {
+        cout << "Ya existe un curso con ese nombre!!!" << endl;
+        return;
+    }
+    const int capacidad = inputCapacidad();
+    if (addCurso(&catalogo, nombre, capacidad, inputTipoRecurso()) == nullptr) {
+        cout << "No se puede registrar el curso en el diario!!!" << endl;
+    }
+}
+
+
+/**
+ * Caso de uso de la aplicación elegido por el usuario mediante menu
+ * cuando quiere cambiar el curso sobre el que trabajan las operaciones
+ * @param catalogo Referencia a una estructura de tipo CatalogoCursos
+ */
+void seleccionarCurso(CatalogoCursos &catalogo) {
+    if (not seleccionarCurso(&catalogo, inputNombreCurso())) {
+        cout << "No existe ningun curso con ese nombre!!!" << endl;
+    }
+}
+
+
+/**
+ * Caso de uso de la aplicación elegido por el usuario mediante menu
+ * cuando quiere eliminar un curso y todos sus alumnos
+ * No se permite eliminar el último curso del catálogo, ya que el menú
+ * siempre necesita un curso seleccionado
+ * @param catalogo Referencia a una estructura de tipo CatalogoCursos
+ */
+void eliminarCurso(CatalogoCursos &catalogo) {
+    if (catalogo.cursos.size() == 1) {
+        cout << "No se puede eliminar el unico curso!!!" << endl;
+        return;
+    }
+    const string nombre = inputNombreCurso();
+    if (buscarCurso(&catalogo, nombre) == -1) {
+        cout << "No existe ningun curso con ese nombre!!!" << endl;
+    } else if (not eliminarCurso(&catalogo, nombre)) {
+        cout << "No se puede registrar la baja del curso en el diario!!!" << endl;
+    }
+}
+
+
+/**
+ * Caso de uso de la aplicación elegido por el usuario mediante menu
+ * cuando quiere ver los cursos del catálogo
+ * Muestra cada curso con su número de alumnos, capacidad y recurso de
+ * memoria (con los bytes del buffer fijo si lo tiene), marcando
+ * con un asterisco el curso seleccionado
+ * @param catalogo Referencia constante a una estructura de tipo CatalogoCursos
+ */
+void printCursos(const CatalogoCursos &catalogo) {
+    cout << "CURSOS:" << endl;
+    for (int i = 0; i < static_cast<int>(catalogo.cursos.size()); i++) {
+        const Curso *curso = catalogo.cursos[i];
+        cout << (i == catalogo.seleccionado ? "* " : "  ") << curso->nombre
+                << "\tAlumnos:" << curso->lista->num << "/" << curso->lista->capacidad
+                << "\tRecurso:" << nombresTiposRecurso[curso->tipoRecurso];
+        if (curso->buffer != nullptr) cout << " (" << curso->bytesBuffer << " bytes)";
+        cout << endl;
+    }
+}
+
+
+/**
+ * Caso de uso de la aplicación elegido por el usuario mediante menu
+ * cuando quiere ver los datos de todos los cursos a la vez
+ * Muestra la nota media de todos los alumnos, el mejor alumno y su curso
+ * y los cursos en los que hay algún alumno suspenso
+ * @param catalogo Referencia constante a una estructura de tipo CatalogoCursos
+ */
+void printInformeGlobal(const CatalogoCursos &catalogo) {
+    const InformeGlobal informe = getInformeGlobal(&catalogo);
+    if (informe.numAlumnos == 0) {
+        cout << "No hay alumnos en ningun curso!!!" << endl;
+        return;
+    }
+    cout << "Alumnos en todos los cursos: " << informe.numAlumnos << endl;
+    cout << "Nota media global: " << static_cast<float>(informe.sumaNotas / informe.numAlumnos) << endl;
+    cout << "Mejor alumno (" << informe.cursoMaxNota->nombre << "): ";
+    printAlumno(informe.maxNota);
+    cout << "Cursos con alumnos suspendidos:";
+    if (informe.cursosConSuspensos.empty()) cout << " ninguno";
+    for (const Curso *curso: informe.cursosConSuspensos) cout << " [" << curso->nombre << "]";
+    cout << endl;
+    printPercentiles(*informe.sketchNotas);
+}
+
+
+/**
+ * Pide la ruta de un fichero mediante entrada por teclado
+ * Comprueba que el texto no esté vacío, de lo contrario
+ * vuelve a pedir al usuario la introducción del dato
+ * @return Un string con la ruta
+ */
+string inputRuta() {
+    string ruta;
+    do {
+        cout << "Introduce la ruta del fichero:";
+        getline(cin, ruta);
+    } while (ruta.empty());
+    return ruta;
+}
+
+
+/**
+ * Imprime por consola en una línea de texto los datos de nombre y nota de
+ * un alumno de una lista paginada, leyendo su nombre del fichero
+ * @param lista Puntero a una estructura constante de tipo ListaPaginada
+ * @param i Posición del alumno en la lista
+ */
+void printAlumno(const ListaPaginada *lista, const int64_t i) {
+    if (lista == nullptr or i < 0 or i >= lista->num) return;
+    cout << "Nombre:" << getNombre(lista, i) << "\tNota:" << lista->notas[i] << endl;
 }
 
 
 /**
- * A partir de valor entero proporcionado como argumento de llamada que indica
- * el máximo número de alumnos que queremos alojar en la lista
- * reserva memoria dinámicamente para crear la estructura ListaAlumnos
- * e inicializa apropiadamente sus campos capacidad y num
- * además de reservar dinámicamente la memoria para los punteros a las
- * estructuras Alumno necesarias de manera contigua en memoria
- * @param capacidad Número máximo de alumnos que queremos que tenga la lista
- * @return devuelve un puntero que apunta a la zona de memoria reservada para
- * los datos de la estructura ListaAlumnos
+ * Caso de uso de la aplicación elegido por el usuario mediante menu
+ * cuando quiere guardar la lista del curso en formato paginado
+ * @param lista Referencia constante a una estructura de tipo ListaAlumnos
  */
-ListaAlumnos *crearLista(const int capacidad) {
-    ListaAlumnos *lista = new ListaAlumnos;
-    lista->capacidad = capacidad;
-    lista->num = 0;
-    lista->alumnos = new Alumno *[lista->capacidad];
-    return lista;
+void guardarListaPaginada(const ListaAlumnos &lista) {
+    const string ruta = inputRuta();
+    if (not guardarListaPaginada(&lista, ruta)) {
+        cout << "No se ha podido guardar la lista en " << ruta << endl;
+        return;
+    }
+    cout << "Lista guardada en " << ruta << endl;
 }
 
+
 /**
- * Libera toda la memoria reservada por la lista de alumnos
- * Para ello, libera
- * la memoria reservada para cada Alumno
- * la memoria reservada para el "array" de punteros a estructura Alumno
- * la memoria de los campos de la propia estructura ListaAlumnos
- * @param lista Puntero a una estructura de tipo ListaAlumnos
+ * Caso de uso de la aplicación elegido por el usuario mediante menu
+ * cuando quiere consultar una lista guardada en formato paginado
+ * Abre la lista y muestra su nota media, el alumno con mayor nota y si
+ * hay alumnos suspensos; solo se lee del disco el nombre del alumno
+ * que se muestra
  */
-void destruirLista(ListaAlumnos *lista) {
-    if (lista == nullptr) return;
-    for (int i = 0; i < lista->num; ++i) {
-        delete lista->alumnos[i]; // Liberamos la memoria reservada por el alumno i-esimo de la lista
-        lista->alumnos[i] = nullptr; //Hacer que el puntero no quede colgante
+void consultarListaPaginada() {
+    const string ruta = inputRuta();
+    ListaPaginada *lista = abrirListaPaginada(ruta);
+    if (lista == nullptr) {
+        cout << "No se puede abrir la lista paginada " << ruta << endl;
+        return;
     }
-
-    delete[] lista->alumnos; // Libera los punteros a estructuras Alumno
-    lista->alumnos = nullptr;
-    delete lista; // Libera la memoria reservada por la estructura ListaAlumnos
+    if (lista->num == 0) {
+        cout << "Lista vacia!!!" << endl;
+    } else {
+        cout << "Alumnos: " << lista->num << endl;
+        cout << "Nota media: " << getNotaMedia(lista) << endl;
+        cout << "Alumno con maxima nota: ";
+        printAlumno(lista, getAlumnoMaxNota(lista));
+        cout << "Hay alumnos suspendidos: " << (existeAlumnoSuspenso(lista) ? "Si" : "No") << endl;
+        SketchKLL sketch;
+        resumirNotas(lista, sketch);
+        printPercentiles(sketch);
+    }
+    cerrarListaPaginada(lista);
 }
 
 
 /**
- * Método que comprueba si una lista proporcionada como argumento de llamada
- * tiene o no alumnos insertados en ella
- * @param lista Puntero a una estructura de tipo ListaAlumnos
- * @return valor bool verdadero si la lista no tiene ningún alumno añadido o
- * falso si la lista ya tiene al menos un alumno
+ * Caso de uso de la aplicación elegido por el usuario mediante menu
+ * cuando quiere obtener ordenada una lista paginada que puede no caber
+ * en memoria
+ * Pide la lista, el criterio, la memoria a usar y dónde escribir el
+ * resultado (un fichero o "-" para la consola) y muestra un resumen
  */
-inline bool estaVacia(const ListaAlumnos *lista) {
-    //Aquí aprovechamos que el operador or es por cortocircuito,
-    //si lo primero es cierto no se evalúa lo segundo
-    //Ya que si no hay lista, no hay numero que comprobar si es cero
-    return lista == nullptr or lista->num == 0;
+void ordenarListaExterna() {
+    cout << "Lista paginada a ordenar. ";
+    const string rutaLista = inputRuta();
+    const CriterioOrden criterio = inputCriterioOrden();
+    int megas;
+    do {
+        cout << "Memoria maxima en MB:";
+        cin >> megas;
+    } while (megas <= 0);
+    cin.get();
+    cout << "Salida (- para la consola). ";
+    const string rutaSalida = inputRuta();
+
+    ofstream fichero;
+    if (rutaSalida != "-") {
+        fichero.open(rutaSalida, ios::binary | ios::trunc);
+        if (not fichero) {
+            cout << "No se ha podido escribir el fichero " << rutaSalida << endl;
+            return;
+        }
+    }
+    ostream &salida = rutaSalida == "-" ? cout : fichero;
+    EstadisticasOrdenacion estadisticas;
+    if (not ordenarListaExterna(rutaLista, criterio, static_cast<size_t>(megas) << 20, salida, estadisticas)) {
+        cout << "No se ha podido ordenar la lista " << rutaLista << endl;
+        return;
+    }
+    cout << "Ordenados " << estadisticas.registros << " alumnos en " << estadisticas.tramos << " tramos y "
+            << estadisticas.pasadas << " pasadas de mezcla (" << estadisticas.segundos << " s)" << endl;
 }
 
 
 /**
- * Método que comprueba si una lista proporcionada como argumento de llamada
- * tiene el máximo de alumnos que puede manejar ya añadidos
- * @param lista Puntero a una estructura de tipo ListaAlumnos
- * @return Valor booleano verdadero si la lista ha llegado al máximo de su capacidad o
- * falso si la lista todavía permite añadir algún alumno más
+ * Muestra por consola el resumen de la carga de un fichero de alumnos
+ * @param resultado Referencia constante a una estructura de tipo ResultadoCarga
  */
-inline bool estaLlena(const ListaAlumnos *lista) {
-    // Aprovechamos que el operador and cortocircuita y no
-    // sigue evaluando el segundo operando (derecha) si el primero es falso
-    return lista != nullptr and lista->num == lista->capacidad;
+void printResultadoCarga(const ResultadoCarga &resultado) {
+    cout << "Lineas: " << resultado.lineas << "\tCargados: " << resultado.cargados
+            << "\tNo validas: " << resultado.invalidos << "\tSin hueco en la lista: " << resultado.sinHueco
+            << "\tRepetidos: " << resultado.duplicados
+            << "\t(" << resultado.segundos << " s)" << endl;
+    if (resultado.sinDiario > 0) {
+        cout << "El diario no admite mas registros: " << resultado.sinDiario << " alumnos no se han cargado" << endl;
+    }
+    if (not resultado.lineasInvalidas.empty()) {
+        cout << "Primeras lineas no validas:";
+        for (const int64_t linea: resultado.lineasInvalidas) cout << " " << linea;
+        cout << endl;
+    }
 }
 
 
 /**
- * Añade un nuevo alumno a la lista después del último alumno de la lista
- * @param lista Puntero a una estructura de tipo ListaAlumnos
- * @param alumno Puntero a una estructura de tipo Alumno con el alumno a añadir
- * @return Verdadero si se ha podido añadir el alumno porque la lista no estaba
- * llena todavía o falso en caso contrario
- */
-bool addAlumno(ListaAlumnos *lista, Alumno *alumno) {
-    if (alumno == nullptr) return false; // Si no hay alumno no hay nada que insertar
-    if (estaLlena(lista)) return false; // Si la lista está llena tampoco
-    lista->alumnos[lista->num++] = alumno; //Copia la dirección del alumno e incrementa num
-    return true;
+ * Caso de uso de la aplicación elegido por el usuario mediante menu
+ * cuando quiere exportar la lista a un fichero binario de registros de
+ * tamaño fijo
+ * @param lista Referencia constante a una estructura de tipo ListaAlumnos
+ */
+void exportarTablaFija(const ListaAlumnos &lista) {
+    const string ruta = inputRuta();
+    const TablaAlumnosFijos tabla = crearTablaFija(&lista);
+    if (not guardarTablaFija(tabla, ruta)) {
+        cout << "No se ha podido escribir el fichero " << ruta << endl;
+        return;
+    }
+    cout << "Exportados " << tabla.registros.size() << " alumnos (" << tabla.desbordados.size()
+            << " bytes de nombres largos) en " << ruta << endl;
 }
 
 
 /**
- * Calcula la nota media de los alumnos de una lista de alumnos proporcionada
- * en un parámetro de entrada de tipo puntero a ListaAlumnos
- * @param lista Puntero a una estructura de tipo ListaAlumnos
- * @return Un float con el valor calculado de la nota media de los alumnos
+ * Caso de uso de la aplicación elegido por el usuario mediante menu
+ * cuando quiere exportar el curso con su informe a JSON lines (ruta
+ * acabada en .jsonl) o al formato binario de tramas
+ * @param curso Referencia constante a una estructura de tipo Curso
  */
-float getNotaMedia(const ListaAlumnos *lista) {
-    if (estaVacia(lista)) return 0;
-    float suma = 0;
-    for (int i = 0; i < lista->num; i++) {
-        suma += lista->alumnos[i]->nota; //Sumamos las notas de todos los alumnos
+void exportarCursoEstructurado(const Curso &curso) {
+    const string ruta = inputRuta();
+    const int64_t bytes = exportarCurso(&curso, ruta);
+    if (bytes < 0) {
+        cout << "No se ha podido escribir el fichero " << ruta << endl;
+        return;
     }
-    return suma / static_cast<float>(lista->num); //suma dividida por total alumnos
+    cout << "Exportados " << curso.lista->num << " alumnos y el informe del curso (" << bytes << " bytes) en "
+            << ruta << endl;
 }
 
 
 /**
- * Recorre la lista de alumnos para encontrar el alumno con mayor nota de todos
- * Debe comprobar si la lista está vacía y en ese caso devolver un puntero nulo
- * Si la lista no está vacía debe devolver un puntero de tipo Alumno con
- * la dirección de memoria donde se ubican los datos del alumno
- * @param lista Puntero a una estructura de tipo ListaAlumnos
- * @return Un puntero a la estructura de tipo Alumno que en la lista tiene mayor nota
+ * Caso de uso de la aplicación elegido por el usuario mediante menu
+ * cuando quiere importar alumnos de un fichero binario de registros de
+ * tamaño fijo
+ * Los alumnos no válidos se saltan y los que no caben en la lista se descartan
+ * @param lista Referencia a una estructura de tipo ListaAlumnos
  */
-Alumno *getAlumnoMaxNota(const ListaAlumnos *lista) {
-    if (estaVacia(lista)) return nullptr;
-    Alumno *max = lista->alumnos[0]; // Asumimos que el primer alumno es el de la nota maxima
-    for (int i = 1; i < lista->num; i++) { // Comparamos con la nota de los siguientes
-        if (lista->alumnos[i]->nota > max->nota) { // Si la nota del alumno i-esimo es mayor
-            max = lista->alumnos[i]; // Este alumno i-esimo se convierte en el alumno de max nota
+void importarTablaFija(ListaAlumnos &lista) {
+    const string ruta = inputRuta();
+    TablaAlumnosFijos tabla;
+    if (not cargarTablaFija(ruta, tabla)) {
+        cout << "No se puede leer el fichero " << ruta << endl;
+        return;
+    }
+    int cargados = 0, invalidos = 0, sinHueco = 0, sinDiario = 0;
+    for (size_t i = 0; i < tabla.registros.size(); i++) {
+        const string_view nombre = getNombre(tabla, i);
+        const float nota = tabla.registros[i].nota;
+        if (not esNombreValido(nombre) or not esNotaValida(nota)) {
+            invalidos++;
+        } else if (estaLlena(&lista)) {
+            sinHueco++;
+        } else if (addAlumno(&lista, nombre, nota)) {
+            cargados++;
+        } else {
+            sinDiario++;
         }
     }
-    return max;
+    cout << "Cargados: " << cargados << "\tNo validos: " << invalidos << "\tSin hueco en la lista: " << sinHueco
+            << endl;
+    if (sinDiario > 0) {
+        cout << "El diario no admite mas registros: " << sinDiario << " alumnos no se han cargado" << endl;
+    }
 }
 
 
 /**
- * Si la lista esta vacía, no existe ningún alumno en ella que este suspendido,
- * por tanto, el método devuelve false.
- * Si la lista contiene alumnos, se recorre hasta que se comprueben todas
- * las notas de todos los alumnos o hasta que se encuentre un alumno
- * cuya nota es inferior a 5
- * Si se llega al final de la lista sin encontrar un alumno con nota inferior
- * a 5 se devuelve falso, si se encuentra antes un alumno con nota inferior
- * a 5 se devuelve verdadero
- * @param lista Puntero a una estructura de tipo ListaAlumnos
- * @return Un bool con valor true si en la lista al menos un alumno tiene una
- * nota inferior a 5 y falso en caso contrario o si la lista esta vacía
+ * Pregunta al usuario si quiere descartar los alumnos repetidos de una carga
+ * @return Verdadero si la respuesta es s
  */
-bool existeAlumnoSuspenso(const ListaAlumnos *lista) {
-    if (estaVacia(lista)) return false;
-    for (int i = 0; i < lista->num; i++) {
-        if (lista->alumnos[i]->nota < 5) return true;
-    }
-    return false;
+bool inputSinDuplicados() {
+    char respuesta;
+    cout << "Descartar alumnos con nombre repetido (s/n):";
+    cin >> respuesta;
+    cin.get();
+    return respuesta == 's' or respuesta == 'S';
 }
 
 
 /**
  * Caso de uso de la aplicación elegido por el usuario mediante menu
- * cuando quiere añadir un nuevo alumno a la lista
- * El método debe comprobar si la lista proporcionada está llena o no
- * Si lo está debe mostrar un mensaje de error y terminar
- * Si no, procede con la llamada a las instrucciones que insertan un nuevo
- * alumno en la lista
+ * cuando quiere cargar alumnos desde un fichero CSV (nombre,nota)
+ * Los alumnos se añaden al final de la lista del curso seleccionado
  * @param lista Referencia a una estructura de tipo ListaAlumnos
  */
-void addAlumno(ListaAlumnos &lista) {
-    if (estaLlena(&lista)) {
-        std::cout << "Lista llena, no se puede insertar el alumno" << endl;
+void cargarCSV(ListaAlumnos &lista) {
+    const string ruta = inputRuta();
+    const bool sinDuplicados = inputSinDuplicados();
+    ResultadoCarga resultado;
+    if (not cargarCSVParalelo(&lista, ruta, resultado, sinDuplicados)) {
+        cout << "No se puede leer el fichero " << ruta << endl;
         return;
     }
-    addAlumno(&lista, inputAlumno());
+    printResultadoCarga(resultado);
 }
 
 
 /**
- * Imprime por consola en una línea de texto los datos de nombre y nota del
- * alumno proporcionado como argumento de llamada
- * @param alumno Puntero a estructura constante de tipo Alumno que apunta
- * al alumno que se va a mostrar por la consola
+ * Caso de uso de la aplicación elegido por el usuario mediante menu
+ * cuando quiere cargar alumnos de un fichero CSV que no se puede
+ * proyectar en memoria (una tubería, un dispositivo...) o que prefiere
+ * leer por bloques
+ * Los alumnos se añaden al final de la lista del curso seleccionado
+ * @param lista Referencia a una estructura de tipo ListaAlumnos
  */
-void printAlumno(const Alumno *alumno) {
-    if (alumno == nullptr) return;
-    cout << "Nombre:" << alumno->nombre << "\tNota:" << alumno->nota << endl;
+void cargarCSVPorBloques(ListaAlumnos &lista) {
+    const string ruta = inputRuta();
+    const bool sinDuplicados = inputSinDuplicados();
+    ResultadoCarga resultado;
+    if (not cargarCSVAsincrono(&lista, ruta, resultado, sinDuplicados)) {
+        cout << "No se puede leer el fichero " << ruta << endl;
+        if (resultado.lineas == 0) return;
+    }
+    printResultadoCarga(resultado);
 }
 
 
 /**
  * Caso de uso de la aplicación elegido por el usuario mediante menu
- * cuando quiere visualizar los datos de la lista
- * El método debe comprobar si la lista proporcionada está vacía o no
- * Si está vacía debe mostrar un mensaje indicando que está vacía
- * Si no, delegando en el método printAlumno recorre e imprime uno tras
- * otro los alumnos de la lista
- * @param lista Referencia constante a una estructura de tipo ListaAlumnos
+ * cuando quiere añadir alumnos de varias fuentes a la vez
+ * Pide ficheros CSV (hasta dejar una ruta vacía), cuántos alumnos
+ * inventados generar y cuántos introducir por teclado, y los añade a la
+ * lista tomando un alumno de cada fuente por turnos
+ * @param lista Referencia a una estructura de tipo ListaAlumnos
  */
-void printLista(const ListaAlumnos &lista) {
-    if (estaVacia(&lista)) {
-        cout << "Lista vacia!!!" << endl;
-        return;
-    }
-    cout << "ALUMNOS:" << endl;
-    for (int i = 0; i < lista.num; i++) {
-        printAlumno(lista.alumnos[i]);
+void cargarDeFuentes(ListaAlumnos &lista) {
+    vector<Generador<RegistroAlumno>> fuentes;
+    string ruta;
+    cout << "Ficheros CSV (linea vacia para terminar)" << endl;
+    while (true) {
+        cout << "Introduce la ruta del fichero:";
+        getline(cin, ruta);
+        if (ruta.empty()) break;
+        fuentes.push_back(fuenteFichero(ruta));
     }
+    int sinteticos, teclado;
+    do {
+        cout << "Alumnos inventados a generar:";
+        cin >> sinteticos;
+    } while (sinteticos < 0);
+    do {
+        cout << "Alumnos a introducir por teclado:";
+        cin >> teclado;
+    } while (teclado < 0);
+    cin.get();
+    // Nombres "Alumno <n>" sin relleno y notas uniformes
+    if (sinteticos > 0) fuentes.push_back(fuenteSintetica({sinteticos, 42, NOTAS_UNIFORME, 1, 1}));
+    if (teclado > 0) fuentes.push_back(fuenteTeclado(teclado));
+    const int64_t cargados = cargarDesdeFuente(intercalarFuentes(std::move(fuentes)), &lista);
+    cout << "Alumnos añadidos: " << cargados << endl;
 }
 
 
 /**
- * Caso de uso de la aplicación elegido por el usuario mediante menu
- * cuando quiere visualizar la nota media de los alumnos
- * El método debe comprobar si la lista proporcionada está vacía o no
- * Si está vacía debe mostrar un mensaje indicando que está vacía y
- * no se va a calcular ninguna nota media
- * Si no, obtiene la media mediante una llamada al método que devuelve
- * la nota media de los alumnos de una lista de alumnos definido anteriormente
- * y la imprime por consola
- * @param lista Referencia constante a una estructura de tipo ListaAlumnos
+ * Pide al usuario una distribución de notas por su nombre
+ * Vuelve a preguntar mientras el nombre no sea válido
+ * @return La distribución elegida
  */
-void printNotaMedia(const ListaAlumnos &lista) {
-    if (estaVacia(&lista)) {
-        cout << "Lista vacia, no se puede calcular ninguna media!!!" << endl;
-        return;
-    }
-    const float media = getNotaMedia(&lista);
-    cout << "Nota media: " << media << endl;
+DistribucionNotas inputDistribucionNotas() {
+    string texto;
+    DistribucionNotas distribucion;
+    do {
+        cout << "Distribucion de notas (uniforme, normal, bimodal, aprobados, suspensos):";
+        getline(cin, texto);
+    } while (not interpretarDistribucion(texto, distribucion));
+    return distribucion;
 }
 
 
 /**
  * Caso de uso de la aplicación elegido por el usuario mediante menu
- * cuando quiere visualizar los datos del alumno con mayor nota
- * El método debe comprobar si la lista proporcionada está vacía o no
- * Si está vacía debe mostrar un mensaje indicando que está vacía y
- * no se buscará ningún alumno
- * Si no, obtiene un puntero al alumno con mejor nota de una lista de alumnos
- * mediante una llamada al método que busca el alumno con la nota maxima
- * en una lista y si este puntero no es un puntero nulo imprime los datos
- * del alumno apoyándose el el método para imprimir los datos de un alumno
- * @param lista Referencia constante a una estructura de tipo ListaAlumnos
+ * cuando quiere llenar la lista con alumnos inventados para pruebas de carga
+ * Pide cuántos alumnos, la distribución de las notas, la longitud mínima y
+ * máxima de los nombres y la semilla
+ * @param lista Referencia a una estructura de tipo ListaAlumnos
  */
-void printAlumnoMaxNota(const ListaAlumnos &lista) {
-    if (estaVacia(&lista)) {
-        cout << "Lista vacia, no se buscara alumno!!!" << endl;
-        return;
-    }
-    Alumno *alumno = getAlumnoMaxNota(&lista);
-    if (alumno != nullptr) {
-        printAlumno(alumno);
-    }
+void generarAlumnos(ListaAlumnos &lista) {
+    ConfigGenerador config{};
+    do {
+        cout << "Alumnos a generar:";
+        cin >> config.cuantos;
+    } while (config.cuantos < 0);
+    cin.get();
+    config.notas = inputDistribucionNotas();
+    do {
+        cout << "Longitud minima y maxima de los nombres (1 a 255):";
+        cin >> config.longitudMinima >> config.longitudMaxima;
+    } while (config.longitudMinima < 1 or config.longitudMaxima > 255 or config.longitudMinima > config.longitudMaxima);
+    cout << "Semilla:";
+    cin >> config.semilla;
+    cin.get();
+    const auto inicio = chrono::steady_clock::now();
+    const int64_t cargados = generarEnLista(config, &lista);
+    cout << "Alumnos añadidos: " << cargados << " ("
+            << chrono::duration<double>(chrono::steady_clock::now() - inicio).count() << " s)" << endl;
 }
 
 
 /**
  * Caso de uso de la aplicación elegido por el usuario mediante menu
- * cuando quiere comprobar si existe algún alumno en la lista que no haya
- * aprobado
- * El método debe comprobar si la lista proporcionada está vacía o no
- * Si está vacía debe mostrar un mensaje indicando que está vacía y
- * no procede buscar
- * Si no, mediante una llamada al método que comprueba a partir de una lista
- * de alumnos si existe alguno suspenso o no obtiene el resultado y muestra por
- * pantalla un texto que diga Si en caso de ser verdadero o No en caso de ser falso
- * el resultado
- * @param lista Referencia constante a una estructura de tipo ListaAlumnos
+ * cuando quiere forzar un punto de control del diario
+ * Muestra un mensaje de error si la aplicación no usa diario o si ya se
+ * está escribiendo otro punto de control
+ * @param catalogo Referencia constante a una estructura de tipo CatalogoCursos
  */
-void printCheckAlumnoSuspenso(const ListaAlumnos &lista) {
-    if (estaVacia(&lista)) {
-        cout << "Lista vacia, no procede!!!" << endl;
+void crearPuntoControl(const CatalogoCursos &catalogo) {
+    if (catalogo.diario == nullptr) {
+        cout << "No hay diario, arranca el programa con --diario <fichero>" << endl;
         return;
     }
-    bool alumnoSuspenso = existeAlumnoSuspenso(&lista);
-    cout << "Hay alumnos suspendidos: " << (alumnoSuspenso ? "Si" : "No") << endl;
+    if (not iniciarPuntoControl(&catalogo)) {
+        cout << "No se ha podido iniciar el punto de control!!!" << endl;
+        return;
+    }
+    cout << "Punto de control iniciado en segundo plano" << endl;
 }
 
 
 /**
  * Imprime el menú de opciones de la aplicación
+ * @param curso Nombre del curso seleccionado sobre el que se trabaja
  */
-void printMenu() {
-    cout << "\nOperaciones:" << endl;
+void printMenu(const string &curso) {
+    cout << "\nOperaciones (curso " << curso << "):" << endl;
     cout << "1. Insertar nuevo alumno" << endl;
     cout << "2. Imprimir lista de alumnos" << endl;
     cout << "3. Mostrar la nota media" << endl;
     cout << "4. Ver alumno con maxima nota" << endl;
     cout << "5. Comprobar si existe algun alumno suspendido" << endl;
+    cout << "6. Ver uso de memoria de la lista" << endl;
+    cout << "7. Crear curso" << endl;
+    cout << "8. Seleccionar curso" << endl;
+    cout << "9. Eliminar curso" << endl;
+    cout << "10. Ver cursos" << endl;
+    cout << "11. Informe global de todos los cursos" << endl;
+    cout << "12. Crear punto de control del diario" << endl;
+    cout << "13. Guardar curso en disco (formato paginado)" << endl;
+    cout << "14. Consultar curso paginado en disco" << endl;
+    cout << "15. Ordenar curso paginado en disco" << endl;
+    cout << "16. Imprimir lista de alumnos ordenada" << endl;
+    cout << "17. Cargar alumnos desde fichero CSV" << endl;
+    cout << "18. Cargar alumnos desde fichero CSV leyendo por bloques" << endl;
+    cout << "19. Cargar alumnos combinando varias fuentes" << endl;
+    cout << "20. Imprimir lista de alumnos por paginas" << endl;
+    cout << "21. Ver uso de la cache de consultas" << endl;
+    cout << "22. Buscar alumno por nombre" << endl;
+    cout << "23. Ver percentiles de notas (aproximados)" << endl;
+    cout << "24. Contar alumnos por franjas de nota" << endl;
+    cout << "25. Ver alumnos con nota entre dos valores" << endl;
+    cout << "26. Exportar curso a fichero binario (registros fijos)" << endl;
+    cout << "27. Importar alumnos de fichero binario (registros fijos)" << endl;
+    cout << "28. Generar alumnos inventados" << endl;
+    cout << "29. Exportar curso e informe (JSON lines o binario)" << endl;
+#ifdef PARCIAL_METRICAS
+    cout << "99. Ver estadisticas de rendimiento" << endl;
+#endif
     cout << "0. Salir" << endl;
     cout << "Opcion:";
 }
 
 
+/**
+ * Añade a la salida del modo por lotes una nota con el texto más corto
+ * que vuelve a dar el mismo float
+ * @param salida Texto de salida
+ * @param nota Nota a escribir
+ */
+void escribirNota(string &salida, const float nota) {
+    char texto[16];
+    salida.append(texto, to_chars(texto, texto + sizeof(texto), nota).ptr);
+}
+
+
+/**
+ * Lee los dos números de una página del modo por lotes: la posición del
+ * primer alumno y el número máximo de alumnos, separados por espacios
+ * @param argumentos Texto con los dos números
+ * @param desplazamiento Donde se guarda la posición del primer alumno
+ * @param limite Donde se guarda el número máximo de alumnos
+ * @return Verdadero si el texto son dos números no negativos
+ */
+bool leerPagina(const string_view argumentos, int &desplazamiento, int &limite) {
+    const char *fin = argumentos.data() + argumentos.size();
+    const auto [finDesplazamiento, errorDesplazamiento] = from_chars(argumentos.data(), fin, desplazamiento);
+    if (errorDesplazamiento != errc{} or desplazamiento < 0) return false;
+    const char *inicioLimite = finDesplazamiento;
+    while (inicioLimite != fin and (*inicioLimite == ' ' or *inicioLimite == '\t')) inicioLimite++;
+    if (inicioLimite == finDesplazamiento) return false;
+    const auto [finLimite, errorLimite] = from_chars(inicioLimite, fin, limite);
+    return errorLimite == errc{} and finLimite == fin and limite >= 0;
+}
+
+
+/**
+ * Ejecuta una orden del modo por lotes sobre una lista y añade su
+ * resultado a la salida, una línea por resultado con los campos separados
+ * por tabuladores y el nombre siempre en el último campo:
+ * alta <nota> <nombre>  ->  alta <posicion>
+ * lista                 ->  lista <num> y una línea alumno <posicion> <nota> <nombre> por alumno
+ * lista <desde> <limite> ->  igual, pero solo con los alumnos de la página
+ *                          que empieza en la posición desde, sin recorrer los anteriores
+ * media                 ->  media <nota>
+ * max                   ->  max <nota> <nombre>, o solo max si la lista está vacía
+ * suspensos             ->  suspensos 1 si hay algún suspenso o 0 si no
+ * num                   ->  num <alumnos> <capacidad>
+ * exportar <ruta>       ->  exportar <bytes>, el curso y su informe (ver exportarCurso)
+ * @param curso Puntero a una estructura de tipo Curso
+ * @param orden Nombre de la orden
+ * @param argumentos Resto de la línea, sin los espacios del principio
+ * @param salida Texto de salida
+ * @return Mensaje de error o nulo si la orden se ha ejecutado
+ */
+const char *ejecutarOrden(Curso *curso, const string_view orden, const string_view argumentos, string &salida) {
+    ListaAlumnos *lista = curso->lista;
+    if (orden == "alta") {
+        const size_t espacio = argumentos.find_first_of(" \t");
+        if (espacio == string_view::npos) return "faltan la nota o el nombre";
+        float nota;
+        const auto [fin, error] = from_chars(argumentos.data(), argumentos.data() + espacio, nota);
+        if (error != errc{} or fin != argumentos.data() + espacio or not esNotaValida(nota)) return "nota no valida";
+        const size_t inicioNombre = argumentos.find_first_not_of(" \t", espacio);
+        if (inicioNombre == string_view::npos) return "faltan la nota o el nombre";
+        const string_view nombre = argumentos.substr(inicioNombre);
+        if (not esNombreValido(nombre)) return "nombre no valido";
+        if (estaLlena(lista)) return "lista llena";
+        if (not addAlumno(lista, nombre, nota)) return "error del diario";
+        salida += "alta\t" + to_string(lista->num - 1) + '\n';
+    } else if (orden == "lista") {
+        int desplazamiento = 0, limite = lista->num;
+        if (not argumentos.empty() and not leerPagina(argumentos, desplazamiento, limite)) return "pagina no valida";
+        salida += "lista\t" + to_string(lista->num) + '\n';
+        const int fin = desplazamiento + max(0, min(limite, lista->num - desplazamiento));
+        for (int i = desplazamiento; i < fin; i++) {
+            salida += "alumno\t" + to_string(i) + '\t';
+            escribirNota(salida, lista->alumnos[i].nota);
+            (salida += '\t').append(lista->alumnos[i].nombre) += '\n';
+        }
+    } else if (orden == "media") {
+        salida += "media\t";
+        escribirNota(salida, getNotaMedia(lista));
+        salida += '\n';
+    } else if (orden == "max") {
+        const Alumno *max = getAlumnoMaxNota(lista);
+        if (max == nullptr) {
+            salida += "max\n";
+        } else {
+            salida += "max\t";
+            escribirNota(salida, max->nota);
+            (salida += '\t').append(max->nombre) += '\n';
+        }
+    } else if (orden == "suspensos") {
+        salida += existeAlumnoSuspenso(lista) ? "suspensos\t1\n" : "suspensos\t0\n";
+    } else if (orden == "num") {
+        salida += "num\t" + to_string(lista->num) + '\t' + to_string(lista->capacidad) + '\n';
+    } else if (orden == "exportar") {
+        if (argumentos.empty()) return "falta la ruta";
+        const int64_t bytes = exportarCurso(curso, string(argumentos));
+        if (bytes < 0) return "no se ha podido escribir el fichero";
+        salida += "exportar\t" + to_string(bytes) + '\n';
+    } else {
+        return "orden desconocida";
+    }
+    return nullptr;
+}
+
+
+/**
+ * Modo por lotes de la aplicación: ejecuta una orden por línea sobre la
+ * lista del curso seleccionado, sin menú ni preguntas, y escribe solo los
+ * resultados (ver ejecutarOrden). Las líneas vacías y las que empiezan por
+ * # se saltan; una orden que falla escribe error <línea> <mensaje> y se
+ * sigue con la siguiente
+ * Igual que en el menú, con diario se hace un punto de control cada
+ * operacionesPuntoControl operaciones registradas
+ * @param catalogo Puntero a una estructura de tipo CatalogoCursos
+ * @param entrada Flujo de donde se leen las órdenes
+ * @param resultados Flujo donde se escriben los resultados
+ * @param operacionesPuntoControl Operaciones entre puntos de control (0: nunca)
+ * @return Número de órdenes que han fallado
+ */
+int64_t ejecutarLotes(CatalogoCursos *catalogo, istream &entrada, ostream &resultados,
+                      const int operacionesPuntoControl) {
+    const size_t TAM_VOLCADO = 1 << 16;
+    Curso *curso = getCursoSeleccionado(catalogo);
+    string linea, salida;
+    int64_t numLinea = 0, errores = 0;
+    while (getline(entrada, linea)) {
+        numLinea++;
+        string_view texto = linea;
+        if (not texto.empty() and texto.back() == '\r') texto.remove_suffix(1);
+        const size_t inicio = texto.find_first_not_of(" \t");
+        if (inicio == string_view::npos or texto[inicio] == '#') continue;
+        texto.remove_prefix(inicio);
+        const size_t espacio = min(texto.find_first_of(" \t"), texto.size());
+        const size_t argumentos = min(texto.find_first_not_of(" \t", espacio), texto.size());
+        const char *error = ejecutarOrden(curso, texto.substr(0, espacio), texto.substr(argumentos), salida);
+        if (error != nullptr) {
+            salida += "error\t" + to_string(numLinea) + '\t' + error + '\n';
+            errores++;
+        }
+        const Diario *diario = catalogo->diario;
+        if (diario != nullptr and operacionesPuntoControl > 0 and
+            diario->registrosPuntoControl >= static_cast<uint64_t>(operacionesPuntoControl)) {
+            iniciarPuntoControl(catalogo);
+        }
+        if (salida.size() >= TAM_VOLCADO) {
+            resultados.write(salida.data(), static_cast<streamsize>(salida.size()));
+            salida.clear();
+        }
+    }
+    resultados.write(salida.data(), static_cast<streamsize>(salida.size()));
+    resultados.flush();
+    return errores;
+}
+
+/**
+ * Modo generador de la aplicación: escribe alumnos sintéticos en un
+ * fichero y muestra cuánto ha tardado
+ * @param config Referencia constante a los parámetros del generador
+ * @param ruta Ruta del fichero a crear; su extensión indica el formato
+ * @return Código de salida del programa: 0 si el fichero se ha escrito
+ */
+int ejecutarGenerador(const ConfigGenerador &config, const string &ruta) {
+    if (ruta.empty()) {
+        cout << "Falta el fichero de salida: --salida <fichero>" << endl;
+        return 1;
+    }
+    const auto inicio = chrono::steady_clock::now();
+    if (not generarFichero(config, ruta)) {
+        cout << "No se ha podido escribir el fichero " << ruta << endl;
+        return 1;
+    }
+    const double segundos = chrono::duration<double>(chrono::steady_clock::now() - inicio).count();
+    cout << "Generados " << config.cuantos << " alumnos en " << ruta << " (" << segundos << " s, "
+            << static_cast<double>(config.cuantos) / segundos * 60 / 1e6 << " millones por minuto)" << endl;
+    return 0;
+}
+
+
 /**
  * método principal y de entrada a la aplicación
  * Inicialización:
- * Crea una estructura Lista de alumnos mediante una llamada al método
- * para crear la lista y al cual le proporciona la capacidad deseada
+ * Crea el catálogo de cursos con un primer curso "General" cuya lista
+ * de alumnos tiene la capacidad deseada
  *
  * El programa entra en un bucle donde muestra un menu de opciones
  * al usuario y pide que introduzca la opción elegida por teclado
  * Según la opción elegida se llamará a la función que corresponda
- * con el caso de uso de para la operación elegida
+ * con el caso de uso de para la operación elegida, trabajando sobre
+ * la lista de alumnos del curso seleccionado
  * Si la opción es 0, que equivale a salir, no se repite el bucle
  * y el programa continua para proceder con las operaciones de limpieza
  * antes de finalizar
+ * Con el argumento --diario <fichero> las operaciones se registran en un
+ * diario que se reproduce al arrancar para recuperar los cursos y alumnos
+ * de ejecuciones anteriores; --ventana-ms <n> fija cada cuántos
+ * milisegundos se sincroniza el diario con el disco (0: en cada operación)
+ * y --punto-control <n> hace un punto de control cada n operaciones
+ * registradas, para que al arrancar solo haya que reproducir las posteriores
+ * Con --hilos <n> se fija el tamaño del pool de hilos que comparten todas
+ * las operaciones paralelas (por defecto, uno por núcleo) y con
+ * --fpr-nombres <p> la tasa de falsos positivos de los filtros de nombres
+ * de las listas (por defecto, 0.01)
+ * Con --simd <variante> se fuerzan los recorridos de notas escalar, sse4.2,
+ * avx2 o avx512 en lugar del mejor que admite el procesador
+ * Con --batch <fichero> (- para la entrada estándar) se ejecutan las
+ * órdenes del fichero sobre el curso seleccionado sin mostrar el menú y
+ * se termina con código 1 si alguna ha fallado; si no hay cursos se crea
+ * "General" con la capacidad de --capacidad <n> (por defecto, 100000)
+ * Con --recurso <tipo> el curso "General" que se crea al arrancar sin
+ * cursos usa ese recurso de memoria: general (por defecto), bloques,
+ * monotonico o buffer
+ * Con --bench-pmr <n> solo mide la carga de n alumnos con cada recurso de
+ * memoria y termina
+ * Con --generar <n> --salida <fichero> solo escribe n alumnos inventados en
+ * el fichero (CSV, o binario si acaba en .afij o .plst) y termina; se
+ * ajustan con --notas <distribucion>, --longitud-nombre <min>-<max> y
+ * --semilla <n>
  * Limpieza:
- * Libera toda la memoria dinámica reservada por el programa
+ * Detiene el pool de hilos, libera toda la memoria dinámica reservada
+ * por el programa y, si se ha compilado con PARCIAL_METRICAS, muestra las métricas
+ * @param argc Número de argumentos de la línea de órdenes
+ * @param argv Argumentos de la línea de órdenes
  * @return
  */
-int main() {
-    const int capacidad = inputCapacidad();
-    ListaAlumnos *lista = crearLista(capacidad);
+int main(const int argc, char *argv[]) {
+    string rutaDiario;
+    int ventanaMs = 10;
+    int operacionesPuntoControl = 100000;
+    int numHilos = static_cast<int>(max(1u, thread::hardware_concurrency()));
+    int alumnosMedidaMemoria = 0;
+    string varianteSimd;
+    ConfigGenerador generador{0, 42, NOTAS_UNIFORME, 12, 40};
+    string rutaGenerador;
+    string rutaLotes;
+    int capacidadLotes = 100000;
+    TipoRecurso recursoGeneral = RECURSO_GENERAL;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        const string argumento = argv[i];
+        if (argumento == "--diario") rutaDiario = argv[i + 1];
+        else if (argumento == "--ventana-ms") ventanaMs = max(0, atoi(argv[i + 1]));
+        else if (argumento == "--punto-control") operacionesPuntoControl = max(0, atoi(argv[i + 1]));
+        else if (argumento == "--hilos") numHilos = max(1, atoi(argv[i + 1]));
+        else if (argumento == "--fpr-nombres") fprFiltroNombres = clamp(atof(argv[i + 1]), 1e-9, 0.5);
+        else if (argumento == "--simd") varianteSimd = argv[i + 1];
+        else if (argumento == "--batch") rutaLotes = argv[i + 1];
+        else if (argumento == "--capacidad") capacidadLotes = max(1, atoi(argv[i + 1]));
+        else if (argumento == "--bench-pmr") alumnosMedidaMemoria = max(1, atoi(argv[i + 1]));
+        else if (argumento == "--generar") generador.cuantos = max(0LL, atoll(argv[i + 1]));
+        else if (argumento == "--semilla") generador.semilla = strtoull(argv[i + 1], nullptr, 10);
+        else if (argumento == "--salida") rutaGenerador = argv[i + 1];
+        else if (argumento == "--notas" and not interpretarDistribucion(argv[i + 1], generador.notas)) {
+            cout << "Distribucion de notas desconocida: " << argv[i + 1] << endl;
+            return 1;
+        } else if (argumento == "--recurso" and not interpretarTipoRecurso(argv[i + 1], recursoGeneral)) {
+            cout << "Recurso de memoria desconocido: " << argv[i + 1] << endl;
+            return 1;
+        } else if (argumento == "--longitud-nombre") { // minima-maxima
+            char *resto;
+            generador.longitudMinima = clamp(static_cast<int>(strtol(argv[i + 1], &resto, 10)), 1, 255);
+            generador.longitudMaxima = *resto == '-' ? clamp(atoi(resto + 1), 1, 255) : generador.longitudMinima;
+            generador.longitudMaxima = max(generador.longitudMinima, generador.longitudMaxima);
+        }
+    }
+    // En el modo por lotes la salida estándar es solo para resultados: los
+    // mensajes del resto de la aplicación van a la salida de errores
+    streambuf *salidaEstandar = cout.rdbuf();
+    if (not rutaLotes.empty()) cout.rdbuf(cerr.rdbuf());
+    if (not varianteSimd.empty() and not forzarVarianteSimd(varianteSimd)) {
+        cout << "Variante " << varianteSimd << " no disponible, se usa " << kernelsNotas->nombre << endl;
+    }
+    iniciarPool(numHilos);
+    if (alumnosMedidaMemoria > 0) {
+        medirRecursosMemoria(alumnosMedidaMemoria);
+        detenerPool();
+        return 0;
+    }
+    if (generador.cuantos > 0) {
+        const int codigo = ejecutarGenerador(generador, rutaGenerador);
+        detenerPool();
+        return codigo;
+    }
 
-    int opcion;
-    do {
-        printMenu();
+    CatalogoCursos *catalogo = crearCatalogo();
+    Diario *diario = nullptr;
+    if (not rutaDiario.empty()) {
+        uint64_t generacion, ultimoLsn;
+        recuperarCatalogo(rutaDiario, catalogo, generacion, ultimoLsn);
+        diario = abrirDiario(rutaDiario, generacion, ventanaMs, ultimoLsn + 1);
+        if (diario == nullptr) {
+            cout << "No se puede abrir el diario " << rutaDiario << endl;
+            destruirCatalogo(catalogo);
+            detenerPool();
+            return 1;
+        }
+        conectarDiario(catalogo, diario);
+    }
+    if (catalogo->cursos.empty()) {
+        addCurso(catalogo, "General", rutaLotes.empty() ? inputCapacidad() : capacidadLotes, recursoGeneral);
+    }
+
+    int codigo = 0;
+    if (not rutaLotes.empty()) {
+        ifstream fichero;
+        if (rutaLotes != "-") fichero.open(rutaLotes);
+        if (rutaLotes != "-" and not fichero) {
+            cout << "No se puede leer el fichero " << rutaLotes << endl;
+            codigo = 1;
+        } else {
+            ostream resultados(salidaEstandar);
+            const int64_t errores = ejecutarLotes(catalogo, rutaLotes == "-" ? cin : fichero, resultados,
+                                                  operacionesPuntoControl);
+            if (errores > 0) codigo = 1;
+        }
+    }
+
+    int opcion = rutaLotes.empty() ? -1 : 0; // En el modo por lotes no se muestra el menú
+    while (opcion != 0) {
+        const Curso *curso = getCursoSeleccionado(catalogo);
+        ListaAlumnos *lista = curso->lista;
+        printMenu(curso->nombre);
         cin >> opcion;
         cin.get();
         switch (opcion) {
@@ -413,14 +7589,78 @@ int main() {
                 break;
             case 5: printCheckAlumnoSuspenso(*lista);
                 break;
+            case 6: printMemoria(*lista);
+                break;
+            case 7: addCurso(*catalogo);
+                break;
+            case 8: seleccionarCurso(*catalogo);
+                break;
+            case 9: eliminarCurso(*catalogo);
+                break;
+            case 10: printCursos(*catalogo);
+                break;
+            case 11: printInformeGlobal(*catalogo);
+                break;
+            case 12: crearPuntoControl(*catalogo);
+                break;
+            case 13: guardarListaPaginada(*lista);
+                break;
+            case 14: consultarListaPaginada();
+                break;
+            case 15: ordenarListaExterna();
+                break;
+            case 16: printListaOrdenada(*lista);
+                break;
+            case 17: cargarCSV(*lista);
+                break;
+            case 18: cargarCSVPorBloques(*lista);
+                break;
+            case 19: cargarDeFuentes(*lista);
+                break;
+            case 20: printListaPorPaginas(*lista);
+                break;
+            case 21: printCacheConsultas(*lista);
+                break;
+            case 22: buscarAlumno(*lista);
+                break;
+            case 23: printPercentiles(*lista);
+                break;
+            case 24: printFranjasNotas(*lista);
+                break;
+            case 25: printAlumnosEntreNotas(*lista);
+                break;
+            case 26: exportarTablaFija(*lista);
+                break;
+            case 27: importarTablaFija(*lista);
+                break;
+            case 28: generarAlumnos(*lista);
+                break;
+            case 29: exportarCursoEstructurado(*curso);
+                break;
+#ifdef PARCIAL_METRICAS
+            case 99: printMetricas();
+                break;
+#endif
             case 0:
                 cout << "Saliendo del programa...";
                 break;
             default: cout << "Opcion incorrecta!" << endl;
         }
-    } while (opcion != 0);
+        if (diario != nullptr and operacionesPuntoControl > 0 and
+            diario->registrosPuntoControl >= static_cast<uint64_t>(operacionesPuntoControl)) {
+            iniciarPuntoControl(catalogo);
+        }
+    }
 
-    destruirLista(lista);
-    lista = nullptr;
-    return 0;
+    cerrarDiario(diario); // Espera al punto de control que pueda estar leyendo los cursos
+    diario = nullptr;
+    conectarDiario(catalogo, nullptr);
+    destruirCatalogo(catalogo);
+    catalogo = nullptr;
+    detenerPool();
+#ifdef PARCIAL_METRICAS
+    printMetricas(); // Volcado de las métricas al salir
+#endif
+    cout.rdbuf(salidaEstandar);
+    return codigo;
 }